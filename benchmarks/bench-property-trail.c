@@ -0,0 +1,412 @@
+/* bench-property-trail.c
+ *
+ * Copyright 2025 Eva M
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/* Measures the paths through which a PastryPropertyTrail resolves again and
+   prints the results as JSON on stdout. Doesn't need a display */
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#include <libpastry.h>
+
+#define ITERATIONS    20000
+#define MEMORY_TRAILS 10000
+
+static const guint depths[]   = { 1, 2, 4, 8, 16 };
+static const guint fan_outs[] = { 1, 10, 100, 1000 };
+
+/* A linked list of objects, so trails of any depth can be built */
+#define BENCH_TYPE_NODE (bench_node_get_type ())
+G_DECLARE_FINAL_TYPE (BenchNode, bench_node, BENCH, NODE, GObject)
+
+enum
+{
+  PROP_0,
+
+  PROP_NEXT,
+  PROP_VALUE,
+
+  LAST_PROP
+};
+static GParamSpec *props[LAST_PROP] = { 0 };
+
+struct _BenchNode
+{
+  GObject parent_instance;
+
+  BenchNode *next;
+  int        value;
+};
+G_DEFINE_FINAL_TYPE (BenchNode, bench_node, G_TYPE_OBJECT)
+
+static void
+bench_node_set_next (BenchNode *self,
+                     BenchNode *next);
+
+static void
+bench_node_set_value (BenchNode *self,
+                      int        value);
+
+static void
+dispose (GObject *object)
+{
+  BenchNode *self = BENCH_NODE (object);
+
+  g_clear_object (&self->next);
+
+  G_OBJECT_CLASS (bench_node_parent_class)->dispose (object);
+}
+
+static void
+get_property (GObject    *object,
+              guint       prop_id,
+              GValue     *value,
+              GParamSpec *pspec)
+{
+  BenchNode *self = BENCH_NODE (object);
+
+  switch (prop_id)
+    {
+    case PROP_NEXT:
+      g_value_set_object (value, self->next);
+      break;
+    case PROP_VALUE:
+      g_value_set_int (value, self->value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+set_property (GObject      *object,
+              guint         prop_id,
+              const GValue *value,
+              GParamSpec   *pspec)
+{
+  BenchNode *self = BENCH_NODE (object);
+
+  switch (prop_id)
+    {
+    case PROP_NEXT:
+      bench_node_set_next (self, g_value_get_object (value));
+      break;
+    case PROP_VALUE:
+      bench_node_set_value (self, g_value_get_int (value));
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+bench_node_class_init (BenchNodeClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->set_property = set_property;
+  object_class->get_property = get_property;
+  object_class->dispose      = dispose;
+
+  props[PROP_NEXT] =
+      g_param_spec_object (
+          "next",
+          NULL, NULL,
+          BENCH_TYPE_NODE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | G_PARAM_EXPLICIT_NOTIFY);
+
+  props[PROP_VALUE] =
+      g_param_spec_int (
+          "value",
+          NULL, NULL,
+          G_MININT, G_MAXINT, 0,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | G_PARAM_EXPLICIT_NOTIFY);
+
+  g_object_class_install_properties (object_class, LAST_PROP, props);
+}
+
+static void
+bench_node_init (BenchNode *self)
+{
+}
+
+static void
+bench_node_set_next (BenchNode *self,
+                     BenchNode *next)
+{
+  if (g_set_object (&self->next, next))
+    g_object_notify_by_pspec (G_OBJECT (self), props[PROP_NEXT]);
+}
+
+static void
+bench_node_set_value (BenchNode *self,
+                      int        value)
+{
+  if (value == self->value)
+    return;
+  self->value = value;
+  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_VALUE]);
+}
+
+/* Returns the root of a list of @length nodes */
+static BenchNode *
+build_chain (guint length)
+{
+  BenchNode *root = NULL;
+
+  for (guint i = 0; i < length; i++)
+    {
+      BenchNode *node = NULL;
+
+      node = g_object_new (BENCH_TYPE_NODE, NULL);
+      bench_node_set_next (node, root);
+      g_clear_object (&root);
+      root = node;
+    }
+
+  return root;
+}
+
+static BenchNode *
+nth_node (BenchNode *root,
+          guint      n)
+{
+  for (guint i = 0; i < n; i++)
+    root = root->next;
+  return root;
+}
+
+/* "next" @depth - 1 times, then "value" */
+static GListModel *
+build_trail (guint depth)
+{
+  GtkStringList *trail = NULL;
+
+  trail = gtk_string_list_new (NULL);
+  for (guint i = 0; i + 1 < depth; i++)
+    gtk_string_list_append (trail, "next");
+  gtk_string_list_append (trail, "value");
+
+  return G_LIST_MODEL (trail);
+}
+
+static PastryPropertyTrail *
+new_trail (BenchNode *root,
+           guint      depth)
+{
+  g_autoptr (GListModel) trail = NULL;
+
+  trail = build_trail (depth);
+  return g_object_new (
+      PASTRY_TYPE_PROPERTY_TRAIL,
+      "object", root,
+      "trail", trail,
+      NULL);
+}
+
+static double
+ns_per_op (gint64 start_us,
+           guint  n_ops)
+{
+  return (g_get_monotonic_time () - start_us) * 1000.0 / n_ops;
+}
+
+static size_t
+allocated_bytes (void)
+{
+#ifdef __GLIBC__
+  return mallinfo2 ().uordblks;
+#else
+  return 0;
+#endif
+}
+
+/* A notify on the last object only resolves the last link, a notify on the
+   root resolves the whole trail */
+static void
+bench_dig (GString *json)
+{
+  g_string_append (json, "  \"dig\": [\n");
+  for (guint i = 0; i < G_N_ELEMENTS (depths); i++)
+    {
+      g_autoptr (BenchNode) root            = NULL;
+      g_autoptr (BenchNode) spare           = NULL;
+      g_autoptr (PastryPropertyTrail) trail = NULL;
+      BenchNode *leaf                       = NULL;
+      BenchNode *first                      = NULL;
+      gint64     start                      = 0;
+      double     leaf_ns                    = 0.0;
+      double     root_ns                    = 0.0;
+
+      root  = build_chain (depths[i] + 1);
+      spare = build_chain (depths[i]);
+      trail = new_trail (root, depths[i]);
+      leaf  = nth_node (root, depths[i] - 1);
+      first = root->next;
+
+      start = g_get_monotonic_time ();
+      for (guint j = 0; j < ITERATIONS; j++)
+        bench_node_set_value (leaf, j + 1);
+      leaf_ns = ns_per_op (start, ITERATIONS);
+
+      /* A trail of depth 1 only has the one object */
+      if (depths[i] > 1)
+        {
+          g_object_ref (first);
+          start = g_get_monotonic_time ();
+          for (guint j = 0; j < ITERATIONS; j++)
+            bench_node_set_next (root, j % 2 == 0 ? spare : first);
+          root_ns = ns_per_op (start, ITERATIONS);
+          g_object_unref (first);
+        }
+      else
+        root_ns = leaf_ns;
+
+      g_string_append_printf (
+          json,
+          "    { \"depth\": %u, \"leaf_notify_ns\": %.1f, \"root_notify_ns\": %.1f }%s\n",
+          depths[i], leaf_ns, root_ns,
+          i + 1 < G_N_ELEMENTS (depths) ? "," : "");
+    }
+  g_string_append (json, "  ],\n");
+}
+
+/* Many trails watching the same object */
+static void
+bench_fan_out (GString *json)
+{
+  g_string_append (json, "  \"fan_out\": [\n");
+  for (guint i = 0; i < G_N_ELEMENTS (fan_outs); i++)
+    {
+      g_autoptr (BenchNode) root   = NULL;
+      g_autoptr (GPtrArray) trails = NULL;
+      gint64 start                 = 0;
+      guint  n_ops                 = 0;
+      double plain_ns              = 0.0;
+      double coalesced_ns          = 0.0;
+
+      root   = build_chain (2);
+      trails = g_ptr_array_new_with_free_func (g_object_unref);
+      for (guint j = 0; j < fan_outs[i]; j++)
+        g_ptr_array_add (trails, new_trail (root, 2));
+
+      n_ops = MAX (ITERATIONS / fan_outs[i], 100);
+      start = g_get_monotonic_time ();
+      for (guint j = 0; j < n_ops; j++)
+        bench_node_set_value (root->next, j + 1);
+      plain_ns = ns_per_op (start, n_ops);
+
+      for (guint j = 0; j < trails->len; j++)
+        pastry_property_trail_set_coalesce (g_ptr_array_index (trails, j), TRUE);
+      start = g_get_monotonic_time ();
+      for (guint j = 0; j < n_ops; j++)
+        {
+          bench_node_set_value (root->next, -(int) j - 1);
+          while (g_main_context_iteration (NULL, FALSE))
+            ;
+        }
+      coalesced_ns = ns_per_op (start, n_ops);
+
+      g_string_append_printf (
+          json,
+          "    { \"trails\": %u, \"notify_ns\": %.1f, \"coalesced_notify_ns\": %.1f }%s\n",
+          fan_outs[i], plain_ns, coalesced_ns,
+          i + 1 < G_N_ELEMENTS (fan_outs) ? "," : "");
+    }
+  g_string_append (json, "  ],\n");
+}
+
+/* Repointing a trail at another root or another path */
+static void
+bench_churn (GString *json)
+{
+  g_autoptr (BenchNode) root_a          = NULL;
+  g_autoptr (BenchNode) root_b          = NULL;
+  g_autoptr (GListModel) path_a         = NULL;
+  g_autoptr (GListModel) path_b         = NULL;
+  g_autoptr (PastryPropertyTrail) trail = NULL;
+  gint64 start                          = 0;
+  double object_ns                      = 0.0;
+  double trail_ns                       = 0.0;
+
+  root_a = build_chain (5);
+  root_b = build_chain (5);
+  path_a = build_trail (4);
+  path_b = build_trail (3);
+  trail  = new_trail (root_a, 4);
+
+  start = g_get_monotonic_time ();
+  for (guint i = 0; i < ITERATIONS; i++)
+    pastry_property_trail_set_object (trail, G_OBJECT (i % 2 == 0 ? root_b : root_a));
+  object_ns = ns_per_op (start, ITERATIONS);
+
+  start = g_get_monotonic_time ();
+  for (guint i = 0; i < ITERATIONS; i++)
+    pastry_property_trail_set_trail (trail, i % 2 == 0 ? path_b : path_a);
+  trail_ns = ns_per_op (start, ITERATIONS);
+
+  g_string_append_printf (
+      json,
+      "  \"churn\": { \"set_object_ns\": %.1f, \"set_trail_ns\": %.1f },\n",
+      object_ns, trail_ns);
+}
+
+static void
+bench_memory (GString *json)
+{
+  g_autoptr (BenchNode) root   = NULL;
+  g_autoptr (GPtrArray) trails = NULL;
+  size_t before                = 0;
+  size_t after                 = 0;
+
+  root   = build_chain (5);
+  trails = g_ptr_array_new_full (MEMORY_TRAILS, g_object_unref);
+
+  before = allocated_bytes ();
+  for (guint i = 0; i < MEMORY_TRAILS; i++)
+    g_ptr_array_add (trails, new_trail (root, 4));
+  after = allocated_bytes ();
+
+  g_string_append_printf (
+      json,
+      "  \"memory\": { \"depth\": 4, \"bytes_per_trail\": %.1f }\n",
+      after > before ? (double) (after - before) / MEMORY_TRAILS : 0.0);
+}
+
+int
+main (int   argc,
+      char *argv[])
+{
+  g_autoptr (GString) json = NULL;
+
+  g_type_ensure (PASTRY_TYPE_PROPERTY_TRAIL);
+
+  json = g_string_new ("{\n");
+  g_string_append_printf (json, "  \"iterations\": %u,\n", ITERATIONS);
+  bench_dig (json);
+  bench_fan_out (json);
+  bench_churn (json);
+  bench_memory (json);
+  g_string_append (json, "}\n");
+
+  g_print ("%s", json->str);
+  return 0;
+}
@@ -0,0 +1,219 @@
+/* bench-startup.c
+ *
+ * Copyright 2025 Eva M
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/* Measures a cold pastry_init () phase by phase, the way a short-lived tool
+   linking libpastry pays for it, and prints the results as JSON on stdout.
+   Meant to run on the private session bus of session.conf, which has no
+   portal, so the numbers don't depend on the desktop it runs on */
+
+#include <bge.h>
+#include <libmanette.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#include <libpastry.h>
+
+#define PORTAL_BUS_NAME           "org.freedesktop.portal.Desktop"
+#define PORTAL_OBJECT_PATH        "/org/freedesktop/portal/desktop"
+#define PORTAL_SETTINGS_INTERFACE "org.freedesktop.portal.Settings"
+#define PORTAL_TIMEOUT_MS         1000
+
+/* The variants ensure_css () may parse, only one of them at startup */
+static const char *stylesheets[] = {
+  "/org/gtk/libgtk/theme/Pastry/gtk.css",
+  "/org/gtk/libgtk/theme/Pastry/gtk-dark.css",
+};
+
+typedef struct
+{
+  GString *json;
+  gint64   start;
+  size_t   start_bytes;
+  gboolean first;
+} Phases;
+
+static size_t
+allocated_bytes (void)
+{
+#ifdef __GLIBC__
+  return mallinfo2 ().uordblks;
+#else
+  return 0;
+#endif
+}
+
+static void
+begin_phase (Phases *phases)
+{
+  phases->start_bytes = allocated_bytes ();
+  phases->start       = g_get_monotonic_time ();
+}
+
+static void
+end_phase (Phases     *phases,
+           const char *name)
+{
+  gint64 elapsed = 0;
+  size_t bytes   = 0;
+
+  elapsed = g_get_monotonic_time () - phases->start;
+  bytes   = allocated_bytes ();
+
+  g_string_append_printf (
+      phases->json,
+      "%s    { \"phase\": \"%s\", \"us\": %" G_GINT64_FORMAT ", \"heap_bytes\": %" G_GINT64_FORMAT " }",
+      phases->first ? "" : ",\n",
+      name, elapsed,
+      (gint64) bytes - (gint64) phases->start_bytes);
+  phases->first = FALSE;
+}
+
+/* What init_portal () waits for, done synchronously so it can be timed */
+static void
+read_portal (void)
+{
+  g_autoptr (GError) error     = NULL;
+  g_autoptr (GDBusProxy) proxy = NULL;
+  g_autoptr (GVariant) ret     = NULL;
+
+  proxy = g_dbus_proxy_new_for_bus_sync (
+      G_BUS_TYPE_SESSION,
+      G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES,
+      NULL,
+      PORTAL_BUS_NAME,
+      PORTAL_OBJECT_PATH,
+      PORTAL_SETTINGS_INTERFACE,
+      NULL,
+      &error);
+  if (proxy == NULL)
+    return;
+
+  ret = g_dbus_proxy_call_sync (
+      proxy,
+      "Read",
+      g_variant_new ("(ss)", "org.freedesktop.appearance", "color-scheme"),
+      G_DBUS_CALL_FLAGS_NONE,
+      PORTAL_TIMEOUT_MS,
+      NULL,
+      &error);
+}
+
+/* What init_manette () does before connecting to any device */
+static guint
+enumerate_controllers (void)
+{
+  g_autoptr (ManetteMonitor) monitor  = NULL;
+  g_autoptr (ManetteMonitorIter) iter = NULL;
+  guint n_devices                     = 0;
+
+  monitor = manette_monitor_new ();
+  iter    = manette_monitor_iterate (monitor);
+  for (;;)
+    {
+      g_autoptr (ManetteDevice) device = NULL;
+
+      if (!manette_monitor_iter_next (iter, &device))
+        break;
+      n_devices++;
+    }
+
+  return n_devices;
+}
+
+int
+main (int   argc,
+      char *argv[])
+{
+  g_autoptr (GString) json = NULL;
+  Phases phases            = { 0 };
+  gint64 start             = 0;
+  guint  n_devices         = 0;
+
+  json         = g_string_new ("{\n");
+  phases.json  = json;
+  phases.first = TRUE;
+  start        = g_get_monotonic_time ();
+
+  begin_phase (&phases);
+  if (!gtk_init_check ())
+    {
+      g_print ("{ \"skipped\": \"no display\" }\n");
+      return 0;
+    }
+  g_string_append (json, "  \"phases\": [\n");
+  end_phase (&phases, "gtk_init");
+
+  begin_phase (&phases);
+  bge_init ();
+  end_phase (&phases, "bge_init");
+
+  begin_phase (&phases);
+  g_type_ensure (PASTRY_TYPE_ANNOTATION_OVERLAY);
+  g_type_ensure (PASTRY_TYPE_FOCUS_OVERLAY);
+  g_type_ensure (PASTRY_TYPE_GLASSED);
+  g_type_ensure (PASTRY_TYPE_GLASS_FRAME);
+  g_type_ensure (PASTRY_TYPE_GLASS_LIST_VIEW);
+  g_type_ensure (PASTRY_TYPE_GLASS_ROOT);
+  g_type_ensure (PASTRY_TYPE_GRID_SPINNER);
+  g_type_ensure (PASTRY_TYPE_PROPERTY_TRAIL);
+  g_type_ensure (PASTRY_TYPE_SETTINGS);
+  g_type_ensure (PASTRY_TYPE_SOUND_THEME);
+  g_type_ensure (PASTRY_TYPE_SPINNER);
+  g_type_ensure (PASTRY_TYPE_STATIC_LAYER);
+  g_type_ensure (PASTRY_TYPE_THEME);
+  g_type_ensure (PASTRY_TYPE_VISUAL_THEME);
+  end_phase (&phases, "type_registration");
+
+  /* Parsed into throwaway providers, pastry_init () parses its own */
+  for (guint i = 0; i < G_N_ELEMENTS (stylesheets); i++)
+    {
+      g_autoptr (GtkCssProvider) provider = NULL;
+      g_autofree char *name               = NULL;
+
+      name = g_strdup_printf ("css:%s", strrchr (stylesheets[i], '/') + 1);
+
+      begin_phase (&phases);
+      provider = gtk_css_provider_new ();
+      gtk_css_provider_load_from_resource (provider, stylesheets[i]);
+      end_phase (&phases, name);
+    }
+
+  begin_phase (&phases);
+  read_portal ();
+  end_phase (&phases, "portal_read");
+
+  begin_phase (&phases);
+  n_devices = enumerate_controllers ();
+  end_phase (&phases, "manette_enumeration");
+
+  /* Everything above is warm now, this is what's left of pastry_init () */
+  begin_phase (&phases);
+  pastry_init ();
+  end_phase (&phases, "pastry_init");
+
+  g_string_append_printf (
+      json,
+      "\n  ],\n  \"controllers\": %u,\n  \"total_us\": %" G_GINT64_FORMAT "\n}\n",
+      n_devices, g_get_monotonic_time () - start);
+
+  g_print ("%s", json->str);
+  return 0;
+}
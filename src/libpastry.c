@@ -41,12 +41,14 @@ pastry_init (void)
   g_type_ensure (PASTRY_TYPE_FOCUS_OVERLAY);
   g_type_ensure (PASTRY_TYPE_GLASSED);
   g_type_ensure (PASTRY_TYPE_GLASS_FRAME);
+  g_type_ensure (PASTRY_TYPE_GLASS_LIST_VIEW);
   g_type_ensure (PASTRY_TYPE_GLASS_ROOT);
   g_type_ensure (PASTRY_TYPE_GRID_SPINNER);
   g_type_ensure (PASTRY_TYPE_PROPERTY_TRAIL);
   g_type_ensure (PASTRY_TYPE_SETTINGS);
   g_type_ensure (PASTRY_TYPE_SOUND_THEME);
   g_type_ensure (PASTRY_TYPE_SPINNER);
+  g_type_ensure (PASTRY_TYPE_STATIC_LAYER);
   g_type_ensure (PASTRY_TYPE_THEME);
   g_type_ensure (PASTRY_TYPE_VISUAL_THEME);
 
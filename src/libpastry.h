@@ -29,6 +29,7 @@ G_BEGIN_DECLS
 #include "pastry-annotation-overlay.h"
 #include "pastry-focus-overlay.h"
 #include "pastry-glass-frame.h"
+#include "pastry-glass-list-view.h"
 #include "pastry-glass-root.h"
 #include "pastry-glassed.h"
 #include "pastry-grid-spinner.h"
@@ -36,6 +37,7 @@ G_BEGIN_DECLS
 #include "pastry-settings.h"
 #include "pastry-sound-theme.h"
 #include "pastry-spinner.h"
+#include "pastry-static-layer.h"
 #include "pastry-theme.h"
 #include "pastry-visual-theme.h"
 #undef LIBPASTRY_INSIDE
@@ -26,11 +26,15 @@
 
 #define G_LOG_DOMAIN "PASTRY::ANNOTATION-OVERLAY"
 
+/* The number of recently shown labels kept around with their text already
+   shaped */
+#define LABEL_CACHE_SIZE 8
+
 #include "pastry-config.h"
 
 #include "pastry-annotation-overlay.h"
+#include "pastry-focus-tracker-private.h"
 #include "pastry-glassed.h"
-#include "pastry-property-trail.h"
 #include "pastry-util.h"
 
 enum
@@ -38,6 +42,7 @@ enum
   PROP_0,
 
   PROP_CHILD,
+  PROP_SETTLE_DELAY,
 
   LAST_PROP
 };
@@ -48,9 +53,18 @@ struct _PastryAnnotationOverlay
   GtkWidget parent_instance;
 
   GtkWidget *child;
-
-  GtkWidget           *label;
-  PastryPropertyTrail *focus_trail;
+  guint      settle_delay;
+
+  GtkWidget          *label;
+  GPtrArray          *labels;
+  gboolean            label_placed;
+  graphene_rect_t     label_rect;
+  PastryFocusTracker *focus_tracker;
+
+  GtkWidget *focus_widget;
+  GtkWidget *pending_focus;
+  guint      settle_timeout;
+  guint      settle_tick;
 };
 
 static void
@@ -65,20 +79,38 @@ G_DEFINE_FINAL_TYPE_WITH_CODE (
 static void
 focus_changed_cb (PastryAnnotationOverlay *self,
                   GtkWidget               *widget,
-                  PastryPropertyTrail     *trail);
+                  PastryFocusTracker      *tracker);
+
+static void
+cancel_settle (PastryAnnotationOverlay *self);
+
+static void
+apply_focus (PastryAnnotationOverlay *self,
+             GtkWidget               *widget);
+
+static GtkWidget *
+acquire_label (PastryAnnotationOverlay *self,
+               const char              *text);
+
+static gboolean
+layout_label (PastryAnnotationOverlay *self,
+              int                      width,
+              int                      height,
+              int                      baseline,
+              graphene_rect_t         *out_rect);
 
 static void
 dispose (GObject *object)
 {
   PastryAnnotationOverlay *self = PASTRY_ANNOTATION_OVERLAY (object);
 
-  g_signal_handlers_disconnect_by_func (
-      self->focus_trail, focus_changed_cb, self);
+  cancel_settle (self);
 
+  self->label = NULL;
   pastry_clear_pointers (
       &self->child, gtk_widget_unparent,
-      &self->label, gtk_widget_unparent,
-      &self->focus_trail, g_object_unref,
+      &self->labels, g_ptr_array_unref,
+      &self->focus_widget, g_object_unref,
       NULL);
 
   G_OBJECT_CLASS (pastry_annotation_overlay_parent_class)->dispose (object);
@@ -97,6 +129,9 @@ get_property (GObject    *object,
     case PROP_CHILD:
       g_value_set_object (value, pastry_annotation_overlay_get_child (self));
       break;
+    case PROP_SETTLE_DELAY:
+      g_value_set_uint (value, pastry_annotation_overlay_get_settle_delay (self));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
     }
@@ -115,6 +150,9 @@ set_property (GObject      *object,
     case PROP_CHILD:
       pastry_annotation_overlay_set_child (self, g_value_get_object (value));
       break;
+    case PROP_SETTLE_DELAY:
+      pastry_annotation_overlay_set_settle_delay (self, g_value_get_uint (value));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
     }
@@ -144,10 +182,55 @@ size_allocate (GtkWidget *widget,
                int        height,
                int        baseline)
 {
-  PastryAnnotationOverlay *self = PASTRY_ANNOTATION_OVERLAY (widget);
+  PastryAnnotationOverlay *self   = PASTRY_ANNOTATION_OVERLAY (widget);
+  gboolean                 placed = FALSE;
+  graphene_rect_t          rect   = { 0 };
 
   if (self->child != NULL && gtk_widget_should_layout (self->child))
     gtk_widget_allocate (self->child, width, height, baseline, NULL);
+
+  /* The label is laid out here rather than in place_glass (), so a text
+     change only has to reallocate this widget and its own glass slot. The
+     slot is left alone unless the label actually moved, appeared or went
+     away */
+  placed = layout_label (self, width, height, baseline, &rect);
+  if (placed == self->label_placed &&
+      (!placed || graphene_rect_equal (&rect, &self->label_rect)))
+    return;
+
+  self->label_placed = placed;
+  self->label_rect   = rect;
+  pastry_glassed_update_glass (PASTRY_GLASSED (self));
+}
+
+static void
+root (GtkWidget *widget)
+{
+  PastryAnnotationOverlay *self = PASTRY_ANNOTATION_OVERLAY (widget);
+
+  GTK_WIDGET_CLASS (pastry_annotation_overlay_parent_class)->root (widget);
+
+  self->focus_tracker = pastry_focus_tracker_acquire (gtk_widget_get_root (widget));
+  g_signal_connect_swapped (
+      self->focus_tracker, "changed",
+      G_CALLBACK (focus_changed_cb), self);
+  focus_changed_cb (
+      self, pastry_focus_tracker_get_focus (self->focus_tracker),
+      self->focus_tracker);
+}
+
+static void
+unroot (GtkWidget *widget)
+{
+  PastryAnnotationOverlay *self = PASTRY_ANNOTATION_OVERLAY (widget);
+
+  g_signal_handlers_disconnect_by_func (
+      self->focus_tracker, focus_changed_cb, self);
+  g_clear_object (&self->focus_tracker);
+  cancel_settle (self);
+  apply_focus (self, NULL);
+
+  GTK_WIDGET_CLASS (pastry_annotation_overlay_parent_class)->unroot (widget);
 }
 
 static void
@@ -182,8 +265,25 @@ pastry_annotation_overlay_class_init (PastryAnnotationOverlayClass *klass)
           GTK_TYPE_WIDGET,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | G_PARAM_EXPLICIT_NOTIFY);
 
+  /**
+   * PastryAnnotationOverlay:settle-delay:
+   *
+   * How long focus must stay on a widget, in milliseconds, before the
+   * annotation follows it. While focus keeps moving faster than this, the
+   * annotation isn't relaid out at all. When 0, the annotation still updates
+   * at most once per frame.
+   */
+  props[PROP_SETTLE_DELAY] =
+      g_param_spec_uint (
+          "settle-delay",
+          NULL, NULL,
+          0, G_MAXUINT, 0,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | G_PARAM_EXPLICIT_NOTIFY);
+
   g_object_class_install_properties (object_class, LAST_PROP, props);
 
+  widget_class->root          = root;
+  widget_class->unroot        = unroot;
   widget_class->measure       = measure;
   widget_class->size_allocate = size_allocate;
   widget_class->snapshot      = snapshot;
@@ -194,28 +294,48 @@ pastry_annotation_overlay_class_init (PastryAnnotationOverlayClass *klass)
 static void
 pastry_annotation_overlay_init (PastryAnnotationOverlay *self)
 {
-  self->label = gtk_label_new (NULL);
-  gtk_widget_set_halign (self->label, GTK_ALIGN_CENTER);
-  gtk_widget_set_parent (self->label, GTK_WIDGET (self));
-
-  self->focus_trail = pastry_property_trail_new (
-      self, "root", "focus-widget", NULL);
-  g_signal_connect_swapped (
-      self->focus_trail, "changed",
-      G_CALLBACK (focus_changed_cb), self);
+  self->labels = g_ptr_array_new_with_free_func ((GDestroyNotify) gtk_widget_unparent);
 }
 
 static gboolean
 place_glass (PastryGlassed  *glassed,
              GskRoundedRect *dest)
 {
-  PastryAnnotationOverlay *self      = PASTRY_ANNOTATION_OVERLAY (glassed);
-  GtkWidget               *widget    = GTK_WIDGET (glassed);
-  const char              *label     = NULL;
-  g_autoptr (GtkWidget) focused      = NULL;
-  double           width             = 0.0;
-  double           height            = 0.0;
-  int              baseline          = -1;
+  PastryAnnotationOverlay *self = PASTRY_ANNOTATION_OVERLAY (glassed);
+
+  if (!self->label_placed)
+    return FALSE;
+
+  dest->bounds = self->label_rect;
+  return TRUE;
+}
+
+static void
+snapshot_overlay (PastryGlassed *glassed,
+                  GtkSnapshot   *snapshot)
+{
+  PastryAnnotationOverlay *self = PASTRY_ANNOTATION_OVERLAY (glassed);
+
+  if (self->label_placed)
+    gtk_widget_snapshot_child (GTK_WIDGET (self), self->label, snapshot);
+}
+
+static void
+glassed_iface_init (PastryGlassedInterface *iface)
+{
+  iface->place_glass      = place_glass;
+  iface->snapshot_overlay = snapshot_overlay;
+}
+
+static gboolean
+layout_label (PastryAnnotationOverlay *self,
+              int                      width,
+              int                      height,
+              int                      baseline,
+              graphene_rect_t         *out_rect)
+{
+  GtkWidget       *widget            = GTK_WIDGET (self);
+  const char      *label             = NULL;
   graphene_rect_t  focus_bounds      = { 0 };
   graphene_rect_t  label_bounds      = { 0 };
   gboolean         success           = FALSE;
@@ -224,19 +344,23 @@ place_glass (PastryGlassed  *glassed,
   graphene_point_t bl                = { 0 };
   g_autoptr (GskTransform) transform = NULL;
 
+  if (self->label == NULL)
+    return FALSE;
   label = gtk_label_get_label (GTK_LABEL (self->label));
   if (label == NULL || *label == '\0')
     return FALSE;
 
-  focused = pastry_property_trail_dup_resolved (self->focus_trail);
-  if (focused == NULL)
+  if (self->focus_widget == NULL)
     return FALSE;
 
-  width    = gtk_widget_get_width (widget);
-  height   = gtk_widget_get_height (widget);
-  baseline = gtk_widget_get_baseline (widget);
-
-  success = gtk_widget_compute_bounds (focused, widget, &focus_bounds);
+  /* While focus is still settling the annotation stays on the widget it
+     describes, which may not be the current focus of the root */
+  if (self->focus_tracker != NULL &&
+      self->focus_widget == pastry_focus_tracker_get_focus (self->focus_tracker))
+    success = pastry_focus_tracker_compute_bounds (
+        self->focus_tracker, widget, &focus_bounds);
+  else
+    success = gtk_widget_compute_bounds (self->focus_widget, widget, &focus_bounds);
   if (!success)
     return FALSE;
   graphene_rect_get_top_left (&focus_bounds, &tl);
@@ -278,24 +402,7 @@ place_glass (PastryGlassed  *glassed,
       baseline,
       g_steal_pointer (&transform));
 
-  g_assert (gtk_widget_compute_bounds (self->label, widget, &dest->bounds));
-  return TRUE;
-}
-
-static void
-snapshot_overlay (PastryGlassed *glassed,
-                  GtkSnapshot   *snapshot)
-{
-  PastryAnnotationOverlay *self = PASTRY_ANNOTATION_OVERLAY (glassed);
-
-  gtk_widget_snapshot_child (GTK_WIDGET (self), self->label, snapshot);
-}
-
-static void
-glassed_iface_init (PastryGlassedInterface *iface)
-{
-  iface->place_glass      = place_glass;
-  iface->snapshot_overlay = snapshot_overlay;
+  return gtk_widget_compute_bounds (self->label, widget, out_rect);
 }
 
 /**
@@ -343,15 +450,116 @@ pastry_annotation_overlay_get_child (PastryAnnotationOverlay *self)
   return self->child;
 }
 
+/**
+ * pastry_annotation_overlay_set_settle_delay:
+ * @self: a `PastryAnnotationOverlay`
+ * @settle_delay: the delay in milliseconds
+ *
+ * Sets how long focus must stay on a widget before the annotation follows it
+ */
+void
+pastry_annotation_overlay_set_settle_delay (PastryAnnotationOverlay *self,
+                                            guint                    settle_delay)
+{
+  g_return_if_fail (PASTRY_IS_ANNOTATION_OVERLAY (self));
+
+  if (settle_delay == self->settle_delay)
+    return;
+  self->settle_delay = settle_delay;
+
+  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_SETTLE_DELAY]);
+}
+
+/**
+ * pastry_annotation_overlay_get_settle_delay
+ * @self: a `PastryAnnotationOverlay`
+ *
+ * Gets how long focus must stay on a widget before the annotation follows it.
+ *
+ * Returns: the settle delay of @self in milliseconds
+ */
+guint
+pastry_annotation_overlay_get_settle_delay (PastryAnnotationOverlay *self)
+{
+  g_return_val_if_fail (PASTRY_IS_ANNOTATION_OVERLAY (self), 0);
+  return self->settle_delay;
+}
+
+static gboolean
+settle_timeout_cb (PastryAnnotationOverlay *self)
+{
+  g_autoptr (GtkWidget) widget = NULL;
+
+  self->settle_timeout = 0;
+
+  widget = g_steal_pointer (&self->pending_focus);
+  apply_focus (self, widget);
+
+  return G_SOURCE_REMOVE;
+}
+
+static gboolean
+settle_tick_cb (PastryAnnotationOverlay *self,
+                GdkFrameClock           *frame_clock,
+                gpointer                 user_data)
+{
+  g_autoptr (GtkWidget) widget = NULL;
+
+  self->settle_tick = 0;
+
+  widget = g_steal_pointer (&self->pending_focus);
+  apply_focus (self, widget);
+
+  return G_SOURCE_REMOVE;
+}
+
 static void
 focus_changed_cb (PastryAnnotationOverlay *self,
                   GtkWidget               *widget,
-                  PastryPropertyTrail     *trail)
+                  PastryFocusTracker      *tracker)
+{
+  g_set_object (&self->pending_focus, widget);
+
+  /* Only the last focus change before things settle is ever applied */
+  if (self->settle_delay > 0)
+    {
+      if (self->settle_timeout != 0)
+        g_source_remove (self->settle_timeout);
+      self->settle_timeout = g_timeout_add (
+          self->settle_delay, (GSourceFunc) settle_timeout_cb, self);
+    }
+  else if (self->settle_tick == 0)
+    self->settle_tick = gtk_widget_add_tick_callback (
+        GTK_WIDGET (self), (GtkTickCallback) settle_tick_cb, NULL, NULL);
+}
+
+static void
+cancel_settle (PastryAnnotationOverlay *self)
+{
+  if (self->settle_timeout != 0)
+    g_source_remove (self->settle_timeout);
+  self->settle_timeout = 0;
+
+  if (self->settle_tick != 0)
+    gtk_widget_remove_tick_callback (GTK_WIDGET (self), self->settle_tick);
+  self->settle_tick = 0;
+
+  g_clear_object (&self->pending_focus);
+}
+
+static void
+apply_focus (PastryAnnotationOverlay *self,
+             GtkWidget               *widget)
 {
   const char *old_label = NULL;
   const char *new_label = NULL;
 
-  old_label = gtk_label_get_label (GTK_LABEL (self->label));
+  if (widget == self->focus_widget)
+    return;
+  g_set_object (&self->focus_widget, widget);
+
+  if (self->label != NULL)
+    old_label = gtk_label_get_label (GTK_LABEL (self->label));
   if (GTK_IS_WIDGET (widget))
     new_label = gtk_widget_get_tooltip_text (widget);
 
@@ -359,6 +567,54 @@ focus_changed_cb (PastryAnnotationOverlay *self,
       (new_label == NULL || *new_label == '\0'))
     return;
 
-  gtk_label_set_label (GTK_LABEL (self->label), new_label);
-  pastry_glassed_queue_draw (PASTRY_GLASSED (self));
+  if (self->label != NULL)
+    gtk_widget_set_child_visible (self->label, FALSE);
+  if (new_label != NULL && *new_label != '\0')
+    {
+      self->label = acquire_label (self, new_label);
+      gtk_widget_set_child_visible (self->label, TRUE);
+    }
+  else
+    self->label = NULL;
+
+  gtk_widget_queue_allocate (GTK_WIDGET (self));
+}
+
+static GtkWidget *
+acquire_label (PastryAnnotationOverlay *self,
+               const char              *text)
+{
+  GtkWidget *label = NULL;
+
+  /* Every label keeps its shaped layout and its size requests, so switching
+     back to a recently shown tooltip never has to measure text again */
+  for (guint i = 0; i < self->labels->len; i++)
+    {
+      GtkWidget *cached = NULL;
+
+      cached = g_ptr_array_index (self->labels, i);
+      if (g_strcmp0 (gtk_label_get_label (GTK_LABEL (cached)), text) == 0)
+        {
+          label = g_ptr_array_steal_index (self->labels, i);
+          break;
+        }
+    }
+
+  if (label == NULL)
+    {
+      if (self->labels->len >= LABEL_CACHE_SIZE)
+        /* Recycle the least recently shown label */
+        label = g_ptr_array_steal_index (self->labels, self->labels->len - 1);
+      else
+        {
+          label = gtk_label_new (NULL);
+          gtk_widget_set_halign (label, GTK_ALIGN_CENTER);
+          gtk_widget_set_child_visible (label, FALSE);
+          gtk_widget_set_parent (label, GTK_WIDGET (self));
+        }
+      gtk_label_set_label (GTK_LABEL (label), text);
+    }
+
+  g_ptr_array_insert (self->labels, 0, label);
+  return label;
 }
@@ -42,5 +42,14 @@ LIBPASTRY_AVAILABLE_IN_ALL
 GtkWidget *
 pastry_annotation_overlay_get_child (PastryAnnotationOverlay *self);
 
+LIBPASTRY_AVAILABLE_IN_ALL
+void
+pastry_annotation_overlay_set_settle_delay (PastryAnnotationOverlay *self,
+                                            guint                    settle_delay);
+
+LIBPASTRY_AVAILABLE_IN_ALL
+guint
+pastry_annotation_overlay_get_settle_delay (PastryAnnotationOverlay *self);
+
 
 G_END_DECLS
@@ -28,13 +28,20 @@
 
 #define INSET_VALUE   5.0
 #define CORNER_RADIUS 15.0
+#define BORDER_WIDTH  2.0
+
+/* The ring gradient points "to top left" and turns clockwise once every
+   RING_PERIOD microseconds */
+#define RING_START_ANGLE 315.0
+#define RING_PERIOD      (6 * G_USEC_PER_SEC)
 
 #include "pastry-config.h"
 
 #include <bge.h>
+#include <math.h>
 
 #include "pastry-focus-overlay.h"
-#include "pastry-property-trail.h"
+#include "pastry-focus-tracker-private.h"
 #include "pastry-util.h"
 
 enum
@@ -42,6 +49,7 @@ enum
   PROP_0,
 
   PROP_CHILD,
+  PROP_ANIMATE_RING,
 
   LAST_PROP
 };
@@ -52,21 +60,29 @@ struct _PastryFocusOverlay
   GtkWidget parent_instance;
 
   GtkWidget *child;
+  gboolean   animate_ring;
 
-  GtkWidget           *frame;
-  PastryPropertyTrail *focus_trail;
+  GtkWidget          *frame;
+  PastryFocusTracker *focus_tracker;
   BgeAnimation        *animation;
 
   GtkWidget      *focus_widget;
+  graphene_rect_t frame_from;
   graphene_rect_t frame_pos;
+
+  GskRenderNode  *ring_gradient;
+  double          ring_angle;
+  guint           ring_tick;
+  GskPath        *ring_path;
+  graphene_rect_t ring_bounds;
 };
 
 G_DEFINE_FINAL_TYPE (PastryFocusOverlay, pastry_focus_overlay, GTK_TYPE_WIDGET)
 
 static void
-focus_changed_cb (PastryFocusOverlay  *self,
-                  GtkWidget           *widget,
-                  PastryPropertyTrail *trail);
+focus_changed_cb (PastryFocusOverlay *self,
+                  GtkWidget          *widget,
+                  PastryFocusTracker *tracker);
 
 static void
 animate (PastryFocusOverlay *self,
@@ -74,20 +90,37 @@ animate (PastryFocusOverlay *self,
          double              value,
          gpointer            user_data);
 
+static void
+update_ring_tick (PastryFocusOverlay *self);
+
+static void
+set_frame_visible (PastryFocusOverlay *self,
+                   gboolean            visible);
+
+static void
+append_ring_gradient (PastryFocusOverlay    *self,
+                      GtkSnapshot           *snapshot,
+                      const graphene_rect_t *bounds);
+
+static GskPath *
+build_ring_path (const graphene_rect_t *bounds);
+
 static void
 dispose (GObject *object)
 {
   PastryFocusOverlay *self = PASTRY_FOCUS_OVERLAY (object);
 
-  g_signal_handlers_disconnect_by_func (
-      self->focus_trail, focus_changed_cb, self);
+  if (self->ring_tick != 0)
+    gtk_widget_remove_tick_callback (GTK_WIDGET (self), self->ring_tick);
+  self->ring_tick = 0;
 
   pastry_clear_pointers (
       &self->child, gtk_widget_unparent,
       &self->frame, gtk_widget_unparent,
-      &self->focus_trail, g_object_unref,
       &self->animation, g_object_unref,
       &self->focus_widget, g_object_unref,
+      &self->ring_gradient, gsk_render_node_unref,
+      &self->ring_path, gsk_path_unref,
       NULL);
 
   G_OBJECT_CLASS (pastry_focus_overlay_parent_class)->dispose (object);
@@ -106,6 +139,9 @@ get_property (GObject    *object,
     case PROP_CHILD:
       g_value_set_object (value, pastry_focus_overlay_get_child (self));
       break;
+    case PROP_ANIMATE_RING:
+      g_value_set_boolean (value, pastry_focus_overlay_get_animate_ring (self));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
     }
@@ -124,6 +160,9 @@ set_property (GObject      *object,
     case PROP_CHILD:
       pastry_focus_overlay_set_child (self, g_value_get_object (value));
       break;
+    case PROP_ANIMATE_RING:
+      pastry_focus_overlay_set_animate_ring (self, g_value_get_boolean (value));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
     }
@@ -153,29 +192,29 @@ size_allocate (GtkWidget *widget,
                int        height,
                int        baseline)
 {
-  PastryFocusOverlay *self    = PASTRY_FOCUS_OVERLAY (widget);
-  g_autoptr (GtkWidget) focus = NULL;
+  PastryFocusOverlay *self  = PASTRY_FOCUS_OVERLAY (widget);
+  GtkWidget          *focus = NULL;
 
   if (self->child != NULL && gtk_widget_should_layout (self->child))
     gtk_widget_allocate (self->child, width, height, baseline, NULL);
 
-  focus = pastry_property_trail_dup_resolved (self->focus_trail);
+  if (self->focus_tracker != NULL)
+    focus = pastry_focus_tracker_get_focus (self->focus_tracker);
   if (focus != NULL &&
       gtk_widget_is_ancestor (focus, widget))
     {
       graphene_rect_t bounds  = { 0 };
       gboolean        success = FALSE;
 
-      success = gtk_widget_compute_bounds (focus, widget, &bounds);
+      success = pastry_focus_tracker_compute_bounds (
+          self->focus_tracker, widget, &bounds);
       if (success)
         {
-          bounds.origin.x += self->frame_pos.origin.x;
-          bounds.origin.y += self->frame_pos.origin.y;
-          bounds.size.width += self->frame_pos.size.width;
-          bounds.size.height += self->frame_pos.size.height;
+          /* The frame is allocated at its resting position, the spring offset
+             is applied in snapshot () so animating never needs a relayout */
           graphene_rect_inset (&bounds, -INSET_VALUE, -INSET_VALUE);
 
-          gtk_widget_set_visible (self->frame, TRUE);
+          set_frame_visible (self, TRUE);
           gtk_widget_allocate (
               self->frame,
               bounds.size.width, bounds.size.height,
@@ -183,10 +222,39 @@ size_allocate (GtkWidget *widget,
               gsk_transform_translate (NULL, &bounds.origin));
         }
       else
-        gtk_widget_set_visible (self->frame, FALSE);
+        set_frame_visible (self, FALSE);
     }
   else
-    gtk_widget_set_visible (self->frame, FALSE);
+    set_frame_visible (self, FALSE);
+}
+
+static void
+root (GtkWidget *widget)
+{
+  PastryFocusOverlay *self = PASTRY_FOCUS_OVERLAY (widget);
+
+  GTK_WIDGET_CLASS (pastry_focus_overlay_parent_class)->root (widget);
+
+  self->focus_tracker = pastry_focus_tracker_acquire (gtk_widget_get_root (widget));
+  g_signal_connect_swapped (
+      self->focus_tracker, "changed",
+      G_CALLBACK (focus_changed_cb), self);
+  focus_changed_cb (
+      self, pastry_focus_tracker_get_focus (self->focus_tracker),
+      self->focus_tracker);
+}
+
+static void
+unroot (GtkWidget *widget)
+{
+  PastryFocusOverlay *self = PASTRY_FOCUS_OVERLAY (widget);
+
+  g_signal_handlers_disconnect_by_func (
+      self->focus_tracker, focus_changed_cb, self);
+  g_clear_object (&self->focus_tracker);
+  focus_changed_cb (self, NULL, NULL);
+
+  GTK_WIDGET_CLASS (pastry_focus_overlay_parent_class)->unroot (widget);
 }
 
 static void
@@ -200,31 +268,53 @@ snapshot (GtkWidget   *widget,
 
   if (gtk_widget_should_layout (self->frame))
     {
-      GskRoundedRect rrect = { 0 };
-
-      g_assert (gtk_widget_compute_bounds (self->frame, widget, &rrect.bounds));
-      graphene_rect_inset (&rrect.bounds, INSET_VALUE, INSET_VALUE);
-      for (guint i = 0; i < G_N_ELEMENTS (rrect.corner); i++)
+      graphene_rect_t target = { 0 };
+      graphene_rect_t frame  = { 0 };
+      graphene_rect_t bounds = { 0 };
+      GskRoundedRect  border = { 0 };
+      GdkRGBA         color  = { 0 };
+
+      if (!gtk_widget_compute_bounds (self->frame, widget, &target))
+        return;
+
+      frame = target;
+      frame.origin.x += self->frame_pos.origin.x;
+      frame.origin.y += self->frame_pos.origin.y;
+      frame.size.width += self->frame_pos.size.width;
+      frame.size.height += self->frame_pos.size.height;
+      if (frame.size.width <= 0.0 || frame.size.height <= 0.0)
+        return;
+
+      /* Everything is built at the animated size and only translated there,
+         so the border, the corners and the ring keep their real dimensions
+         while the ring moves. The frame is only allocated to style it */
+      bounds = GRAPHENE_RECT_INIT (0.0, 0.0, frame.size.width, frame.size.height);
+      gtk_snapshot_save (snapshot);
+      gtk_snapshot_translate (snapshot, &frame.origin);
+
+      /* The ring is filled directly with an even-odd path, so unlike a mask
+         it never has to render the gradient into an offscreen first. Moving
+         without resizing reuses the path */
+      if (self->ring_path == NULL ||
+          !graphene_rect_equal (&self->ring_bounds, &bounds))
         {
-          rrect.corner[i].width  = CORNER_RADIUS;
-          rrect.corner[i].height = CORNER_RADIUS;
+          g_clear_pointer (&self->ring_path, gsk_path_unref);
+          self->ring_path   = build_ring_path (&bounds);
+          self->ring_bounds = bounds;
         }
 
-      gtk_snapshot_push_mask (snapshot, GSK_MASK_MODE_INVERTED_ALPHA);
-      gtk_snapshot_push_rounded_clip (snapshot, &rrect);
-      gtk_snapshot_append_color (
-          snapshot,
-          &(GdkRGBA){
-              .red   = 0.0,
-              .green = 0.0,
-              .blue  = 0.0,
-              .alpha = 1.0,
-          },
-          &rrect.bounds);
-      gtk_snapshot_pop (snapshot);
-      gtk_snapshot_pop (snapshot);
-      gtk_widget_snapshot_child (widget, self->frame, snapshot);
+      gtk_snapshot_push_fill (snapshot, self->ring_path, GSK_FILL_RULE_EVEN_ODD);
+      append_ring_gradient (self, snapshot, &bounds);
       gtk_snapshot_pop (snapshot);
+
+      gtk_widget_get_color (self->frame, &color);
+      gsk_rounded_rect_init_from_rect (&border, &bounds, CORNER_RADIUS);
+      gtk_snapshot_append_border (
+          snapshot, &border,
+          (const float[4]){ BORDER_WIDTH, BORDER_WIDTH, BORDER_WIDTH, BORDER_WIDTH },
+          (const GdkRGBA[4]){ color, color, color, color });
+
+      gtk_snapshot_restore (snapshot);
     }
 }
 
@@ -250,8 +340,23 @@ pastry_focus_overlay_class_init (PastryFocusOverlayClass *klass)
           GTK_TYPE_WIDGET,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | G_PARAM_EXPLICIT_NOTIFY);
 
+  /**
+   * PastryFocusOverlay:animate-ring:
+   *
+   * Whether the gradient of the focus ring rotates. When %FALSE the ring
+   * stays still and no frame clock updates are requested while idle.
+   */
+  props[PROP_ANIMATE_RING] =
+      g_param_spec_boolean (
+          "animate-ring",
+          NULL, NULL,
+          TRUE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | G_PARAM_EXPLICIT_NOTIFY);
+
   g_object_class_install_properties (object_class, LAST_PROP, props);
 
+  widget_class->root          = root;
+  widget_class->unroot        = unroot;
   widget_class->measure       = measure;
   widget_class->size_allocate = size_allocate;
   widget_class->snapshot      = snapshot;
@@ -262,16 +367,29 @@ pastry_focus_overlay_class_init (PastryFocusOverlayClass *klass)
 static void
 pastry_focus_overlay_init (PastryFocusOverlay *self)
 {
+  static const GskColorStop stops[] = {
+    { 0.00, { 0.611765, 0.388235, 0.866667, 1.0 } },
+    { 0.10, { 0.611765, 0.388235, 0.866667, 1.0 } },
+    { 0.61, { 0.611765, 0.388235, 0.866667, 1.0 } },
+    { 0.97, { 0.058824, 0.713725, 1.000000, 1.0 } },
+    { 1.00, { 0.058824, 0.713725, 1.000000, 1.0 } },
+  };
+
+  self->animate_ring = TRUE;
+  self->ring_angle   = RING_START_ANGLE;
+
+  /* A unit gradient pointing "to top", append_ring_gradient () rotates and
+     scales it over the ring every frame without rebuilding it */
+  self->ring_gradient = gsk_linear_gradient_node_new (
+      &GRAPHENE_RECT_INIT (-1.0, -1.0, 2.0, 2.0),
+      &GRAPHENE_POINT_INIT (0.0, 1.0),
+      &GRAPHENE_POINT_INIT (0.0, -1.0),
+      stops, G_N_ELEMENTS (stops));
+
   self->frame = gtk_frame_new (NULL);
   gtk_widget_set_visible (self->frame, FALSE);
   gtk_widget_set_parent (self->frame, GTK_WIDGET (self));
 
-  self->focus_trail = pastry_property_trail_new (
-      self, "root", "focus-widget", NULL);
-  g_signal_connect_swapped (
-      self->focus_trail, "changed",
-      G_CALLBACK (focus_changed_cb), self);
-
   self->animation = bge_animation_new (GTK_WIDGET (self));
 }
 
@@ -320,10 +438,47 @@ pastry_focus_overlay_get_child (PastryFocusOverlay *self)
   return self->child;
 }
 
+/**
+ * pastry_focus_overlay_set_animate_ring:
+ * @self: a `PastryFocusOverlay`
+ * @animate_ring: whether the focus ring gradient rotates
+ *
+ * Sets whether the gradient of the focus ring rotates
+ */
+void
+pastry_focus_overlay_set_animate_ring (PastryFocusOverlay *self,
+                                       gboolean            animate_ring)
+{
+  g_return_if_fail (PASTRY_IS_FOCUS_OVERLAY (self));
+
+  animate_ring = !!animate_ring;
+  if (animate_ring == self->animate_ring)
+    return;
+  self->animate_ring = animate_ring;
+
+  update_ring_tick (self);
+  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_ANIMATE_RING]);
+}
+
+/**
+ * pastry_focus_overlay_get_animate_ring
+ * @self: a `PastryFocusOverlay`
+ *
+ * Gets whether the gradient of the focus ring rotates
+ *
+ * Returns: whether the focus ring of @self is animated
+ */
+gboolean
+pastry_focus_overlay_get_animate_ring (PastryFocusOverlay *self)
+{
+  g_return_val_if_fail (PASTRY_IS_FOCUS_OVERLAY (self), FALSE);
+  return self->animate_ring;
+}
+
 static void
-focus_changed_cb (PastryFocusOverlay  *self,
-                  GtkWidget           *widget,
-                  PastryPropertyTrail *trail)
+focus_changed_cb (PastryFocusOverlay *self,
+                  GtkWidget          *widget,
+                  PastryFocusTracker *tracker)
 {
   gboolean        success      = FALSE;
   graphene_rect_t old_bounds   = { 0 };
@@ -333,14 +488,15 @@ focus_changed_cb (PastryFocusOverlay  *self,
   if (widget == NULL)
     {
       g_clear_object (&self->focus_widget);
+      update_ring_tick (self);
       gtk_widget_queue_allocate (GTK_WIDGET (self));
       return;
     }
 
   if (self->focus_widget != NULL)
     {
-      success = gtk_widget_compute_bounds (
-          widget, GTK_WIDGET (self), &old_bounds);
+      success = pastry_focus_tracker_compute_bounds (
+          tracker, GTK_WIDGET (self), &old_bounds);
       if (success)
         {
           success = gtk_widget_compute_bounds (
@@ -356,36 +512,24 @@ focus_changed_cb (PastryFocusOverlay  *self,
     }
   g_clear_object (&self->focus_widget);
   self->focus_widget = g_object_ref (widget);
+  update_ring_tick (self);
+
+  /* Moves the frame's resting position, the springs below only redraw */
+  gtk_widget_queue_allocate (GTK_WIDGET (self));
 
 #define DAMPING_RATIO 1.0
 #define MASS          0.1
 #define STIFFNESS     100.0
 
+  /* All four components share the same spring parameters and start at rest,
+     so a single spring from 1 to 0 scaling the whole offset keeps them in
+     phase with one callback per frame */
+  self->frame_from = animate_from;
+  self->frame_pos  = animate_from;
   bge_animation_add_spring (
       self->animation,
-      "x",
-      animate_from.origin.x, 0.0,
-      DAMPING_RATIO, MASS, STIFFNESS,
-      (BgeAnimationCallback) animate,
-      NULL, NULL, NULL);
-  bge_animation_add_spring (
-      self->animation,
-      "y",
-      animate_from.origin.y, 0.0,
-      DAMPING_RATIO, MASS, STIFFNESS,
-      (BgeAnimationCallback) animate,
-      NULL, NULL, NULL);
-  bge_animation_add_spring (
-      self->animation,
-      "w",
-      animate_from.size.width, 0.0,
-      DAMPING_RATIO, MASS, STIFFNESS,
-      (BgeAnimationCallback) animate,
-      NULL, NULL, NULL);
-  bge_animation_add_spring (
-      self->animation,
-      "h",
-      animate_from.size.height, 0.0,
+      "frame",
+      1.0, 0.0,
       DAMPING_RATIO, MASS, STIFFNESS,
       (BgeAnimationCallback) animate,
       NULL, NULL, NULL);
@@ -397,14 +541,107 @@ animate (PastryFocusOverlay *self,
          double              value,
          gpointer            user_data)
 {
-  if (g_strcmp0 (key, "x") == 0)
-    self->frame_pos.origin.x = value;
-  else if (g_strcmp0 (key, "y") == 0)
-    self->frame_pos.origin.y = value;
-  else if (g_strcmp0 (key, "w") == 0)
-    self->frame_pos.size.width = value;
-  else if (g_strcmp0 (key, "h") == 0)
-    self->frame_pos.size.height = value;
+  self->frame_pos.origin.x    = self->frame_from.origin.x * value;
+  self->frame_pos.origin.y    = self->frame_from.origin.y * value;
+  self->frame_pos.size.width  = self->frame_from.size.width * value;
+  self->frame_pos.size.height = self->frame_from.size.height * value;
 
-  gtk_widget_queue_allocate (GTK_WIDGET (self));
+  gtk_widget_queue_draw (GTK_WIDGET (self));
+}
+
+static gboolean
+ring_tick_cb (PastryFocusOverlay *self,
+              GdkFrameClock      *frame_clock,
+              gpointer            user_data)
+{
+  gint64 frame_time = 0;
+
+  frame_time       = gdk_frame_clock_get_frame_time (frame_clock);
+  self->ring_angle = RING_START_ANGLE +
+                     360.0 * (double) (frame_time % RING_PERIOD) /
+                         (double) RING_PERIOD;
+
+  gtk_widget_queue_draw (GTK_WIDGET (self));
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+update_ring_tick (PastryFocusOverlay *self)
+{
+  gboolean want_tick = FALSE;
+
+  /* Only run while this overlay shows a ring, other overlays of the window
+     stay idle */
+  want_tick = self->animate_ring &&
+              gtk_widget_get_visible (self->frame) &&
+              self->focus_widget != NULL &&
+              self->child != NULL &&
+              (self->focus_widget == self->child ||
+               gtk_widget_is_ancestor (self->focus_widget, self->child));
+
+  if (want_tick && self->ring_tick == 0)
+    self->ring_tick = gtk_widget_add_tick_callback (
+        GTK_WIDGET (self), (GtkTickCallback) ring_tick_cb, NULL, NULL);
+  else if (!want_tick && self->ring_tick != 0)
+    {
+      gtk_widget_remove_tick_callback (GTK_WIDGET (self), self->ring_tick);
+      self->ring_tick = 0;
+    }
+}
+
+static void
+set_frame_visible (PastryFocusOverlay *self,
+                   gboolean            visible)
+{
+  if (visible == gtk_widget_get_visible (self->frame))
+    return;
+
+  gtk_widget_set_visible (self->frame, visible);
+  update_ring_tick (self);
+}
+
+static void
+append_ring_gradient (PastryFocusOverlay    *self,
+                      GtkSnapshot           *snapshot,
+                      const graphene_rect_t *bounds)
+{
+  graphene_point_t center  = { 0 };
+  double           radians = 0.0;
+  double           radius  = 0.0;
+  double           length  = 0.0;
+
+  graphene_rect_get_center (bounds, &center);
+  radians = self->ring_angle * G_PI / 180.0;
+  radius  = hypot (bounds->size.width, bounds->size.height) / 2.0;
+  /* The same gradient line length CSS uses for this angle */
+  length = fabs (bounds->size.width * sin (radians)) +
+           fabs (bounds->size.height * cos (radians));
+
+  gtk_snapshot_save (snapshot);
+  gtk_snapshot_translate (snapshot, &center);
+  gtk_snapshot_rotate (snapshot, self->ring_angle);
+  gtk_snapshot_scale (snapshot, radius, length / 2.0);
+  gtk_snapshot_append_node (snapshot, self->ring_gradient);
+  gtk_snapshot_restore (snapshot);
+}
+
+static GskPath *
+build_ring_path (const graphene_rect_t *bounds)
+{
+  g_autoptr (GskPathBuilder) builder = NULL;
+  GskRoundedRect outer               = { 0 };
+  GskRoundedRect inner               = { 0 };
+
+  gsk_rounded_rect_init_from_rect (&outer, bounds, CORNER_RADIUS);
+  inner = outer;
+  inner.bounds.origin.x += INSET_VALUE;
+  inner.bounds.origin.y += INSET_VALUE;
+  inner.bounds.size.width -= 2.0 * INSET_VALUE;
+  inner.bounds.size.height -= 2.0 * INSET_VALUE;
+
+  builder = gsk_path_builder_new ();
+  gsk_path_builder_add_rounded_rect (builder, &outer);
+  gsk_path_builder_add_rounded_rect (builder, &inner);
+
+  return gsk_path_builder_to_path (builder);
 }
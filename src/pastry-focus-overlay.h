@@ -42,4 +42,13 @@ LIBPASTRY_AVAILABLE_IN_ALL
 GtkWidget *
 pastry_focus_overlay_get_child (PastryFocusOverlay *self);
 
+LIBPASTRY_AVAILABLE_IN_ALL
+void
+pastry_focus_overlay_set_animate_ring (PastryFocusOverlay *self,
+                                       gboolean            animate_ring);
+
+LIBPASTRY_AVAILABLE_IN_ALL
+gboolean
+pastry_focus_overlay_get_animate_ring (PastryFocusOverlay *self);
+
 G_END_DECLS
@@ -0,0 +1,218 @@
+/* pastry-focus-tracker.c
+ *
+ * Copyright 2025 Eva M
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/* PastryFocusTracker:
+ *
+ * Follows the focus widget of a single `GtkRoot` on behalf of every overlay
+ * inside of it. Overlays share the tracker attached to their root instead of
+ * each connecting to the root themselves, and the bounds of the focus widget
+ * are computed at most once per frame no matter how many overlays ask.
+ */
+
+#define G_LOG_DOMAIN "PASTRY::FOCUS-TRACKER"
+
+#define TRACKER_KEY "pastry-focus-tracker"
+
+#include "pastry-config.h"
+
+#include "pastry-focus-tracker-private.h"
+
+enum
+{
+  SIGNAL_CHANGED,
+
+  LAST_SIGNAL,
+};
+static guint signals[LAST_SIGNAL];
+
+struct _PastryFocusTracker
+{
+  GObject parent_instance;
+
+  GtkRoot   *root;
+  GtkWidget *focus;
+
+  gboolean        bounds_valid;
+  gboolean        bounds_success;
+  gint64          bounds_frame;
+  graphene_rect_t bounds;
+};
+G_DEFINE_FINAL_TYPE (PastryFocusTracker, pastry_focus_tracker, G_TYPE_OBJECT)
+
+static void
+focus_widget_changed_cb (PastryFocusTracker *self,
+                         GParamSpec         *pspec,
+                         GtkRoot            *root);
+
+static gint64
+get_frame_counter (PastryFocusTracker *self);
+
+static void
+dispose (GObject *object)
+{
+  PastryFocusTracker *self = PASTRY_FOCUS_TRACKER (object);
+
+  if (self->root != NULL)
+    g_object_remove_weak_pointer (G_OBJECT (self->root), (gpointer *) &self->root);
+  self->root = NULL;
+
+  g_clear_object (&self->focus);
+
+  G_OBJECT_CLASS (pastry_focus_tracker_parent_class)->dispose (object);
+}
+
+static void
+pastry_focus_tracker_class_init (PastryFocusTrackerClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->dispose = dispose;
+
+  /* PastryFocusTracker::changed:
+   * @tracker: the object that received the signal
+   * @focus: the new focus widget, or %NULL
+   *
+   * Emitted when the focus widget of the root changes
+   */
+  signals[SIGNAL_CHANGED] =
+      g_signal_new (
+          "changed",
+          G_OBJECT_CLASS_TYPE (klass),
+          G_SIGNAL_RUN_FIRST,
+          0,
+          NULL, NULL,
+          g_cclosure_marshal_VOID__OBJECT,
+          G_TYPE_NONE, 1,
+          GTK_TYPE_WIDGET);
+  g_signal_set_va_marshaller (
+      signals[SIGNAL_CHANGED],
+      G_TYPE_FROM_CLASS (klass),
+      g_cclosure_marshal_VOID__OBJECTv);
+}
+
+static void
+pastry_focus_tracker_init (PastryFocusTracker *self)
+{
+}
+
+/* Returns the tracker attached to @root, creating it on first use. The root
+   owns one reference, so the tracker lives exactly as long as the root */
+PastryFocusTracker *
+pastry_focus_tracker_acquire (GtkRoot *root)
+{
+  PastryFocusTracker *self = NULL;
+
+  g_return_val_if_fail (GTK_IS_ROOT (root), NULL);
+
+  self = g_object_get_data (G_OBJECT (root), TRACKER_KEY);
+  if (self != NULL)
+    return g_object_ref (self);
+
+  self       = g_object_new (PASTRY_TYPE_FOCUS_TRACKER, NULL);
+  self->root = root;
+  g_object_add_weak_pointer (G_OBJECT (root), (gpointer *) &self->root);
+
+  g_signal_connect_object (
+      root, "notify::focus-widget",
+      G_CALLBACK (focus_widget_changed_cb), self,
+      G_CONNECT_SWAPPED);
+  g_set_object (&self->focus, gtk_root_get_focus (root));
+
+  g_object_set_data_full (G_OBJECT (root), TRACKER_KEY, self, g_object_unref);
+  return g_object_ref (self);
+}
+
+GtkWidget *
+pastry_focus_tracker_get_focus (PastryFocusTracker *self)
+{
+  g_return_val_if_fail (PASTRY_IS_FOCUS_TRACKER (self), NULL);
+  return self->focus;
+}
+
+/* Computes the bounds of the focus widget in the coordinate space of @target.
+   The bounds relative to the root are shared by every caller within the same
+   frame, only the final transform into @target is done per call */
+gboolean
+pastry_focus_tracker_compute_bounds (PastryFocusTracker *self,
+                                     GtkWidget          *target,
+                                     graphene_rect_t    *out_bounds)
+{
+  gint64            frame     = 0;
+  graphene_matrix_t transform = { 0 };
+
+  g_return_val_if_fail (PASTRY_IS_FOCUS_TRACKER (self), FALSE);
+  g_return_val_if_fail (GTK_IS_WIDGET (target), FALSE);
+  g_return_val_if_fail (out_bounds != NULL, FALSE);
+
+  if (self->root == NULL || self->focus == NULL)
+    return FALSE;
+
+  frame = get_frame_counter (self);
+  if (!self->bounds_valid || frame != self->bounds_frame)
+    {
+      self->bounds_success = gtk_widget_compute_bounds (
+          self->focus, GTK_WIDGET (self->root), &self->bounds);
+      self->bounds_frame = frame;
+      self->bounds_valid = TRUE;
+    }
+  if (!self->bounds_success)
+    return FALSE;
+
+  if (target == GTK_WIDGET (self->root))
+    {
+      *out_bounds = self->bounds;
+      return TRUE;
+    }
+
+  if (!gtk_widget_compute_transform (GTK_WIDGET (self->root), target, &transform))
+    return FALSE;
+  graphene_matrix_transform_bounds (&transform, &self->bounds, out_bounds);
+  return TRUE;
+}
+
+static void
+focus_widget_changed_cb (PastryFocusTracker *self,
+                         GParamSpec         *pspec,
+                         GtkRoot            *root)
+{
+  GtkWidget *focus = NULL;
+
+  focus = gtk_root_get_focus (root);
+  if (focus == self->focus)
+    return;
+
+  g_set_object (&self->focus, focus);
+  self->bounds_valid = FALSE;
+
+  g_signal_emit (self, signals[SIGNAL_CHANGED], 0, focus);
+}
+
+static gint64
+get_frame_counter (PastryFocusTracker *self)
+{
+  GdkFrameClock *frame_clock = NULL;
+
+  /* Without a frame clock, layout can't change between calls either */
+  frame_clock = gtk_widget_get_frame_clock (GTK_WIDGET (self->root));
+  if (frame_clock != NULL)
+    return gdk_frame_clock_get_frame_counter (frame_clock);
+  else
+    return -1;
+}
@@ -0,0 +1,451 @@
+/* pastry-glass-list-view.c
+ *
+ * Copyright 2025 Eva M
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * PastryGlassListView:
+ *
+ * Presents a large `GListModel` with a `GtkListView`, drawing every visible
+ * row as a glass card.
+ *
+ * Unlike nesting a `PastryGlassFrame` in each row, all rows share a single
+ * slot and blur pass of the enclosing `PastryGlassRoot`; each row only masks
+ * its own region out of the shared blurred backdrop. Rows are recycled by the
+ * underlying `GtkListView`, so the cost of the effect only depends on the
+ * number of rows on screen.
+ */
+
+#define G_LOG_DOMAIN "PASTRY::GLASS-LIST-VIEW"
+
+#include "pastry-config.h"
+
+#include "pastry-glass-list-view.h"
+#include "pastry-glassed.h"
+#include "pastry-util.h"
+
+enum
+{
+  PROP_0,
+
+  PROP_MODEL,
+  PROP_FACTORY,
+
+  LAST_PROP
+};
+static GParamSpec *props[LAST_PROP] = { 0 };
+
+struct _PastryGlassListView
+{
+  GtkWidget parent_instance;
+
+  GtkWidget *scroll;
+  GtkWidget *list_view;
+};
+
+static void
+glassed_iface_init (PastryGlassedInterface *iface);
+
+static gboolean
+compute_row_box (PastryGlassListView *self,
+                 GtkWidget           *row,
+                 GskRoundedRect      *out_box);
+
+G_DEFINE_FINAL_TYPE_WITH_CODE (
+    PastryGlassListView,
+    pastry_glass_list_view,
+    GTK_TYPE_WIDGET,
+    G_IMPLEMENT_INTERFACE (PASTRY_TYPE_GLASSED, glassed_iface_init))
+
+static void
+dispose (GObject *object)
+{
+  PastryGlassListView *self = PASTRY_GLASS_LIST_VIEW (object);
+
+  self->list_view = NULL;
+  pastry_clear_pointers (
+      &self->scroll, gtk_widget_unparent,
+      NULL);
+
+  G_OBJECT_CLASS (pastry_glass_list_view_parent_class)->dispose (object);
+}
+
+static void
+get_property (GObject    *object,
+              guint       prop_id,
+              GValue     *value,
+              GParamSpec *pspec)
+{
+  PastryGlassListView *self = PASTRY_GLASS_LIST_VIEW (object);
+
+  switch (prop_id)
+    {
+    case PROP_MODEL:
+      g_value_set_object (value, pastry_glass_list_view_get_model (self));
+      break;
+    case PROP_FACTORY:
+      g_value_set_object (value, pastry_glass_list_view_get_factory (self));
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+set_property (GObject      *object,
+              guint         prop_id,
+              const GValue *value,
+              GParamSpec   *pspec)
+{
+  PastryGlassListView *self = PASTRY_GLASS_LIST_VIEW (object);
+
+  switch (prop_id)
+    {
+    case PROP_MODEL:
+      pastry_glass_list_view_set_model (self, g_value_get_object (value));
+      break;
+    case PROP_FACTORY:
+      pastry_glass_list_view_set_factory (self, g_value_get_object (value));
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+measure (GtkWidget     *widget,
+         GtkOrientation orientation,
+         int            for_size,
+         int           *minimum,
+         int           *natural,
+         int           *minimum_baseline,
+         int           *natural_baseline)
+{
+  PastryGlassListView *self = PASTRY_GLASS_LIST_VIEW (widget);
+
+  gtk_widget_measure (
+      self->scroll, orientation,
+      for_size, minimum, natural,
+      minimum_baseline, natural_baseline);
+}
+
+static void
+size_allocate (GtkWidget *widget,
+               int        width,
+               int        height,
+               int        baseline)
+{
+  PastryGlassListView *self = PASTRY_GLASS_LIST_VIEW (widget);
+
+  if (gtk_widget_should_layout (self->scroll))
+    gtk_widget_allocate (self->scroll, width, height, baseline, NULL);
+}
+
+static void
+snapshot (GtkWidget   *widget,
+          GtkSnapshot *snapshot)
+{
+  /* The rows are drawn above the glass in snapshot_overlay () */
+  return;
+}
+
+static void
+pastry_glass_list_view_class_init (PastryGlassListViewClass *klass)
+{
+  GObjectClass   *object_class = G_OBJECT_CLASS (klass);
+  GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (klass);
+
+  object_class->set_property = set_property;
+  object_class->get_property = get_property;
+  object_class->dispose      = dispose;
+
+  /**
+   * PastryGlassListView:model:
+   *
+   * The model of items to present
+   */
+  props[PROP_MODEL] =
+      g_param_spec_object (
+          "model",
+          NULL, NULL,
+          GTK_TYPE_SELECTION_MODEL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | G_PARAM_EXPLICIT_NOTIFY);
+
+  /**
+   * PastryGlassListView:factory:
+   *
+   * The factory used to create the widget inside of each row
+   */
+  props[PROP_FACTORY] =
+      g_param_spec_object (
+          "factory",
+          NULL, NULL,
+          GTK_TYPE_LIST_ITEM_FACTORY,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | G_PARAM_EXPLICIT_NOTIFY);
+
+  g_object_class_install_properties (object_class, LAST_PROP, props);
+
+  widget_class->measure       = measure;
+  widget_class->size_allocate = size_allocate;
+  widget_class->snapshot      = snapshot;
+
+  gtk_widget_class_set_css_name (widget_class, "pastry-glass-list-view");
+}
+
+static void
+pastry_glass_list_view_init (PastryGlassListView *self)
+{
+  self->list_view = gtk_list_view_new (NULL, NULL);
+
+  self->scroll = gtk_scrolled_window_new ();
+  gtk_scrolled_window_set_policy (
+      GTK_SCROLLED_WINDOW (self->scroll),
+      GTK_POLICY_NEVER, GTK_POLICY_AUTOMATIC);
+  gtk_scrolled_window_set_child (GTK_SCROLLED_WINDOW (self->scroll), self->list_view);
+  gtk_widget_set_parent (self->scroll, GTK_WIDGET (self));
+}
+
+static gboolean
+place_glass (PastryGlassed  *glassed,
+             GskRoundedRect *dest)
+{
+  GtkWidget *widget = GTK_WIDGET (glassed);
+  double     width  = 0.0;
+  double     height = 0.0;
+
+  width  = gtk_widget_get_width (widget);
+  height = gtk_widget_get_height (widget);
+
+  /* Only reserves our slot, the real shape comes from snapshot_mask () */
+  gsk_rounded_rect_init_from_rect (
+      dest, &GRAPHENE_RECT_INIT (0.0, 0.0, width, height), 0.0);
+  return TRUE;
+}
+
+static void
+snapshot_overlay (PastryGlassed *glassed,
+                  GtkSnapshot   *snapshot)
+{
+  PastryGlassListView *self = PASTRY_GLASS_LIST_VIEW (glassed);
+
+  gtk_widget_snapshot_child (GTK_WIDGET (self), self->scroll, snapshot);
+}
+
+static gboolean
+snapshot_mask (PastryGlassed *glassed,
+               GtkSnapshot   *snapshot)
+{
+  PastryGlassListView *self     = PASTRY_GLASS_LIST_VIEW (glassed);
+  GtkWidget           *widget   = GTK_WIDGET (glassed);
+  graphene_rect_t      viewport = { 0 };
+
+  if (!gtk_widget_compute_bounds (self->scroll, widget, &viewport))
+    return FALSE;
+
+  gtk_snapshot_push_clip (snapshot, &viewport);
+
+  /* GtkListView only keeps widgets for the rows around the viewport, so this
+     never walks more than a screenful of rows regardless of model size */
+  for (GtkWidget *child = gtk_widget_get_first_child (self->list_view);
+       child != NULL;
+       child = gtk_widget_get_next_sibling (child))
+    {
+      GskRoundedRect rrect   = { 0 };
+      GskRoundedRect row_box = { 0 };
+
+      if (!gtk_widget_get_child_visible (child) ||
+          !gtk_widget_get_visible (child) ||
+          g_strcmp0 (gtk_widget_get_css_name (child), "row") != 0)
+        continue;
+
+      if (!gtk_widget_compute_bounds (child, widget, &rrect.bounds) ||
+          !graphene_rect_intersection (&rrect.bounds, &viewport, NULL))
+        continue;
+
+      /* The shape follows the theme, only the corners are taken from the
+         row's border box since the bounds are already in our coordinates */
+      if (compute_row_box (self, child, &row_box))
+        gsk_rounded_rect_init (
+            &rrect, &rrect.bounds,
+            &row_box.corner[0], &row_box.corner[1],
+            &row_box.corner[2], &row_box.corner[3]);
+      else
+        gsk_rounded_rect_init_from_rect (&rrect, &rrect.bounds, 0.0);
+      gtk_snapshot_push_rounded_clip (snapshot, &rrect);
+      gtk_snapshot_append_color (
+          snapshot,
+          &(GdkRGBA){
+              .red   = 0.0,
+              .green = 0.0,
+              .blue  = 0.0,
+              .alpha = 1.0,
+          },
+          &rrect.bounds);
+      gtk_snapshot_pop (snapshot);
+    }
+
+  gtk_snapshot_pop (snapshot);
+  return TRUE;
+}
+
+static void
+glassed_iface_init (PastryGlassedInterface *iface)
+{
+  iface->place_glass      = place_glass;
+  iface->snapshot_overlay = snapshot_overlay;
+  iface->snapshot_mask    = snapshot_mask;
+}
+
+/**
+ * pastry_glass_list_view_set_model:
+ * @self: a `PastryGlassListView`
+ * @model: (nullable): the model to present
+ *
+ * Sets the model of items to present
+ */
+void
+pastry_glass_list_view_set_model (PastryGlassListView *self,
+                                  GtkSelectionModel   *model)
+{
+  g_return_if_fail (PASTRY_IS_GLASS_LIST_VIEW (self));
+  g_return_if_fail (model == NULL || GTK_IS_SELECTION_MODEL (model));
+
+  if (model == gtk_list_view_get_model (GTK_LIST_VIEW (self->list_view)))
+    return;
+  gtk_list_view_set_model (GTK_LIST_VIEW (self->list_view), model);
+
+  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_MODEL]);
+}
+
+/**
+ * pastry_glass_list_view_get_model:
+ * @self: a `PastryGlassListView`
+ *
+ * Gets the model of items presented by @self.
+ *
+ * Returns: (nullable) (transfer none): the model presented by @self
+ */
+GtkSelectionModel *
+pastry_glass_list_view_get_model (PastryGlassListView *self)
+{
+  g_return_val_if_fail (PASTRY_IS_GLASS_LIST_VIEW (self), NULL);
+  return gtk_list_view_get_model (GTK_LIST_VIEW (self->list_view));
+}
+
+/**
+ * pastry_glass_list_view_set_factory:
+ * @self: a `PastryGlassListView`
+ * @factory: (nullable): the factory used to create row widgets
+ *
+ * Sets the factory used to create the widget inside of each row
+ */
+void
+pastry_glass_list_view_set_factory (PastryGlassListView *self,
+                                    GtkListItemFactory  *factory)
+{
+  g_return_if_fail (PASTRY_IS_GLASS_LIST_VIEW (self));
+  g_return_if_fail (factory == NULL || GTK_IS_LIST_ITEM_FACTORY (factory));
+
+  if (factory == gtk_list_view_get_factory (GTK_LIST_VIEW (self->list_view)))
+    return;
+  gtk_list_view_set_factory (GTK_LIST_VIEW (self->list_view), factory);
+
+  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_FACTORY]);
+}
+
+/**
+ * pastry_glass_list_view_get_factory:
+ * @self: a `PastryGlassListView`
+ *
+ * Gets the factory used to create row widgets for @self.
+ *
+ * Returns: (nullable) (transfer none): the row factory of @self
+ */
+GtkListItemFactory *
+pastry_glass_list_view_get_factory (PastryGlassListView *self)
+{
+  g_return_val_if_fail (PASTRY_IS_GLASS_LIST_VIEW (self), NULL);
+  return gtk_list_view_get_factory (GTK_LIST_VIEW (self->list_view));
+}
+
+/* GTK doesn't expose the computed border radius of a widget, but the CSS
+   border box of the row is in its render node: the clip of its rounded
+   background or the outline of its border, whichever comes first. The node
+   is cached by GTK until the row changes, so this doesn't redraw it */
+static gboolean
+compute_row_box (PastryGlassListView *self,
+                 GtkWidget           *row,
+                 GskRoundedRect      *out_box)
+{
+  g_autoptr (GtkSnapshot) snapshot = NULL;
+  g_autoptr (GskRenderNode) node   = NULL;
+  GskRenderNode *cur_node          = NULL;
+
+  snapshot = gtk_snapshot_new ();
+  gtk_widget_snapshot_child (self->list_view, row, snapshot);
+  node = gtk_snapshot_to_node (snapshot);
+  if (node == NULL)
+    return FALSE;
+
+  /* Look through the row's transform and any opacity or debug wrapping */
+  cur_node = node;
+  for (;;)
+    {
+      GskRenderNodeType type = GSK_NOT_A_RENDER_NODE;
+
+      type = gsk_render_node_get_node_type (cur_node);
+      if (type == GSK_TRANSFORM_NODE)
+        cur_node = gsk_transform_node_get_child (cur_node);
+      else if (type == GSK_OPACITY_NODE)
+        cur_node = gsk_opacity_node_get_child (cur_node);
+      else if (type == GSK_DEBUG_NODE)
+        cur_node = gsk_debug_node_get_child (cur_node);
+      else
+        break;
+    }
+
+  /* Only the row's own nodes, not those of its content */
+  for (guint i = 0;; i++)
+    {
+      GskRenderNode    *child = NULL;
+      GskRenderNodeType type  = GSK_NOT_A_RENDER_NODE;
+
+      if (gsk_render_node_get_node_type (cur_node) == GSK_CONTAINER_NODE)
+        {
+          if (i >= gsk_container_node_get_n_children (cur_node))
+            return FALSE;
+          child = gsk_container_node_get_child (cur_node, i);
+        }
+      else if (i == 0)
+        child = cur_node;
+      else
+        return FALSE;
+
+      type = gsk_render_node_get_node_type (child);
+      if (type == GSK_ROUNDED_CLIP_NODE)
+        {
+          *out_box = *gsk_rounded_clip_node_get_clip (child);
+          return TRUE;
+        }
+      else if (type == GSK_BORDER_NODE)
+        {
+          *out_box = *gsk_border_node_get_outline (child);
+          return TRUE;
+        }
+    }
+}
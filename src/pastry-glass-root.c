@@ -31,8 +31,7 @@
 
 #include "pastry-config.h"
 
-#include "pastry-glass-root.h"
-#include "pastry-glassed.h"
+#include "pastry-glass-root-private.h"
 #include "pastry-util.h"
 
 enum
@@ -56,6 +55,11 @@ struct _PastryGlassRoot
 
   GPtrArray *glass_widgets;
   GPtrArray *caches;
+  gboolean   allocating;
+
+  GPtrArray     *pending;
+  GdkFrameClock *frame_clock;
+  gulong         after_layout;
 };
 
 G_DEFINE_FINAL_TYPE (PastryGlassRoot, pastry_glass_root, GTK_TYPE_WIDGET)
@@ -79,10 +83,26 @@ search_glass_allocate (PastryGlassRoot *self,
                        int              baseline,
                        GtkWidget       *widget);
 
+static void
+allocate_glass_widget (PastryGlassRoot      *self,
+                       GtkWidget            *glassed,
+                       GtkWidget            *glass_widget,
+                       const GskRoundedRect *rrect,
+                       graphene_rect_t      *bounds,
+                       int                   baseline);
+
 static void
 fill_glass_widgets (PastryGlassRoot *self,
                     guint            from);
 
+static gboolean
+update_glassed (PastryGlassRoot *self,
+                PastryGlassed   *glassed);
+
+static void
+after_layout_cb (PastryGlassRoot *self,
+                 GdkFrameClock   *frame_clock);
+
 static void
 dispose (GObject *object)
 {
@@ -92,6 +112,7 @@ dispose (GObject *object)
       &self->child, gtk_widget_unparent,
       &self->glass_widgets, g_ptr_array_unref,
       &self->caches, g_ptr_array_unref,
+      &self->pending, g_ptr_array_unref,
       NULL);
 
   G_OBJECT_CLASS (pastry_glass_root_parent_class)->dispose (object);
@@ -174,11 +195,41 @@ size_allocate (GtkWidget *widget,
   g_ptr_array_set_size (self->caches, 0);
   if (self->child != NULL && gtk_widget_should_layout (self->child))
     {
+      self->allocating = TRUE;
       gtk_widget_allocate (self->child, width, height, baseline, NULL);
       search_glass_allocate (self, baseline, self->child);
+      self->allocating = FALSE;
     }
 }
 
+static void
+realize (GtkWidget *widget)
+{
+  PastryGlassRoot *self = PASTRY_GLASS_ROOT (widget);
+
+  GTK_WIDGET_CLASS (pastry_glass_root_parent_class)->realize (widget);
+
+  /* Connected for as long as the root is realized, a handler connected from
+     within the layout phase would only run on the next one */
+  self->frame_clock  = g_object_ref (gtk_widget_get_frame_clock (widget));
+  self->after_layout = g_signal_connect_object (
+      self->frame_clock, "layout",
+      G_CALLBACK (after_layout_cb), self,
+      G_CONNECT_SWAPPED | G_CONNECT_AFTER);
+}
+
+static void
+unrealize (GtkWidget *widget)
+{
+  PastryGlassRoot *self = PASTRY_GLASS_ROOT (widget);
+
+  g_clear_signal_handler (&self->after_layout, self->frame_clock);
+  g_clear_object (&self->frame_clock);
+  g_ptr_array_set_size (self->pending, 0);
+
+  GTK_WIDGET_CLASS (pastry_glass_root_parent_class)->unrealize (widget);
+}
+
 static void
 snapshot (GtkWidget   *widget,
           GtkSnapshot *snapshot)
@@ -196,6 +247,7 @@ snapshot (GtkWidget   *widget,
       GlassChild *cache                        = NULL;
       g_autoptr (GskRenderNode) aggregate_node = NULL;
       GtkWidget *glass_widget                  = NULL;
+      gboolean   custom_mask                   = FALSE;
       g_autoptr (GskRenderNode) glass_node     = NULL;
 
       cache = g_ptr_array_index (self->caches, i - 1);
@@ -206,12 +258,28 @@ snapshot (GtkWidget   *widget,
       g_assert (i - 1 < self->glass_widgets->len);
       glass_widget = g_ptr_array_index (self->glass_widgets, i - 1);
       tmp_snapshot = gtk_snapshot_new ();
-      gtk_widget_snapshot_child (widget, glass_widget, tmp_snapshot);
+      gtk_snapshot_save (tmp_snapshot);
+      gtk_snapshot_translate (tmp_snapshot, &cache->bounds.origin);
+      custom_mask = pastry_glassed_snapshot_mask (PASTRY_GLASSED (cache->widget), tmp_snapshot);
+      gtk_snapshot_restore (tmp_snapshot);
+      if (!custom_mask)
+        gtk_widget_snapshot_child (widget, glass_widget, tmp_snapshot);
       glass_node = gtk_snapshot_to_node (tmp_snapshot);
       g_clear_object (&tmp_snapshot);
 
       tmp_snapshot = gtk_snapshot_new ();
 
+      if (glass_node == NULL)
+        {
+          /* nothing to blur, e.g. a custom mask with no visible shapes */
+          gtk_snapshot_append_node (tmp_snapshot, aggregate_node);
+          gtk_snapshot_save (tmp_snapshot);
+          gtk_snapshot_translate (tmp_snapshot, &cache->bounds.origin);
+          pastry_glassed_snapshot_overlay (PASTRY_GLASSED (cache->widget), tmp_snapshot);
+          gtk_snapshot_restore (tmp_snapshot);
+          continue;
+        }
+
       /* draw everything outside of the blurred area */
       gtk_snapshot_push_mask (tmp_snapshot, GSK_MASK_MODE_INVERTED_ALPHA);
       gtk_snapshot_append_node (tmp_snapshot, glass_node);
@@ -228,8 +296,10 @@ snapshot (GtkWidget   *widget,
       gtk_snapshot_pop (tmp_snapshot);
       gtk_snapshot_pop (tmp_snapshot);
 
-      /* Append the glass widget and its overlay */
-      gtk_snapshot_append_node (tmp_snapshot, glass_node);
+      /* Append the glass widget and its overlay. Custom masks only describe
+         the shape, so the glassed widget draws any decoration itself */
+      if (!custom_mask)
+        gtk_snapshot_append_node (tmp_snapshot, glass_node);
       gtk_snapshot_save (tmp_snapshot);
       gtk_snapshot_translate (tmp_snapshot, &cache->bounds.origin);
       pastry_glassed_snapshot_overlay (PASTRY_GLASSED (cache->widget), tmp_snapshot);
@@ -290,6 +360,8 @@ pastry_glass_root_class_init (PastryGlassRootClass *klass)
 
   widget_class->measure       = measure;
   widget_class->size_allocate = size_allocate;
+  widget_class->realize       = realize;
+  widget_class->unrealize     = unrealize;
   widget_class->snapshot      = snapshot;
 
   gtk_widget_class_set_css_name (widget_class, "pastry-glass-root");
@@ -307,6 +379,7 @@ pastry_glass_root_init (PastryGlassRoot *self)
 
   self->caches = g_ptr_array_new_with_free_func (
       (GDestroyNotify) destroy_glass_child);
+  self->pending = g_ptr_array_new_with_free_func (g_object_unref);
 }
 
 /**
@@ -445,27 +518,16 @@ search_glass_allocate (PastryGlassRoot *self,
       do_glass = pastry_glassed_place_glass (PASTRY_GLASSED (widget), &rrect);
       if (do_glass)
         {
-          guint           idx                = 0;
-          graphene_rect_t bounds             = { 0 };
-          GtkWidget      *glass_widget       = NULL;
-          g_autoptr (GskTransform) transform = NULL;
-          GlassChild *cache                  = NULL;
+          guint           idx          = 0;
+          graphene_rect_t bounds       = { 0 };
+          GtkWidget      *glass_widget = NULL;
+          GlassChild     *cache        = NULL;
 
           idx = self->caches->len;
           g_assert (idx < self->glass_widgets->len);
 
-          g_assert (gtk_widget_compute_bounds (widget, GTK_WIDGET (self), &bounds));
           glass_widget = g_ptr_array_index (self->glass_widgets, idx);
-          transform    = gsk_transform_translate (
-              NULL, &GRAPHENE_POINT_INIT (
-                        rrect.bounds.origin.x + bounds.origin.x,
-                        rrect.bounds.origin.y + bounds.origin.y));
-          gtk_widget_allocate (
-              glass_widget,
-              rrect.bounds.size.width,
-              rrect.bounds.size.height,
-              baseline,
-              g_steal_pointer (&transform));
+          allocate_glass_widget (self, widget, glass_widget, &rrect, &bounds, baseline);
 
           if (self->caches->len >= self->glass_widgets->len)
             {
@@ -493,6 +555,48 @@ search_glass_allocate (PastryGlassRoot *self,
   return TRUE;
 }
 
+/* Schedules the glass of a single glassed descendant to be re-placed once
+   the current layout is done, without reallocating the rest of the tree */
+void
+pastry_glass_root_queue_update_glassed (PastryGlassRoot *self,
+                                        PastryGlassed   *glassed)
+{
+  g_return_if_fail (PASTRY_IS_GLASS_ROOT (self));
+  g_return_if_fail (PASTRY_IS_GLASSED (glassed));
+
+  /* Already being placed by search_glass_allocate (), or placed on the first
+     allocation after realizing */
+  if (self->allocating || self->frame_clock == NULL)
+    return;
+
+  if (!g_ptr_array_find (self->pending, glassed, NULL))
+    g_ptr_array_add (self->pending, g_object_ref (glassed));
+  gdk_frame_clock_request_phase (self->frame_clock, GDK_FRAME_CLOCK_PHASE_LAYOUT);
+}
+
+static void
+allocate_glass_widget (PastryGlassRoot      *self,
+                       GtkWidget            *glassed,
+                       GtkWidget            *glass_widget,
+                       const GskRoundedRect *rrect,
+                       graphene_rect_t      *bounds,
+                       int                   baseline)
+{
+  g_autoptr (GskTransform) transform = NULL;
+
+  g_assert (gtk_widget_compute_bounds (glassed, GTK_WIDGET (self), bounds));
+  transform = gsk_transform_translate (
+      NULL, &GRAPHENE_POINT_INIT (
+                rrect->bounds.origin.x + bounds->origin.x,
+                rrect->bounds.origin.y + bounds->origin.y));
+  gtk_widget_allocate (
+      glass_widget,
+      rrect->bounds.size.width,
+      rrect->bounds.size.height,
+      baseline,
+      g_steal_pointer (&transform));
+}
+
 static void
 fill_glass_widgets (PastryGlassRoot *self,
                     guint            from)
@@ -506,3 +610,67 @@ fill_glass_widgets (PastryGlassRoot *self,
       g_ptr_array_index (self->glass_widgets, i) = child;
     }
 }
+
+/* Returns FALSE if the glassed widget gained or lost its glass, in which case
+   the slots need to be rebuilt with a full allocation */
+static gboolean
+update_glassed (PastryGlassRoot *self,
+                PastryGlassed   *glassed)
+{
+  GskRoundedRect rrect    = { 0 };
+  gboolean       do_glass = FALSE;
+
+  do_glass = pastry_glassed_place_glass (glassed, &rrect);
+  for (guint i = 0; i < self->caches->len; i++)
+    {
+      GlassChild *cache = NULL;
+
+      cache = g_ptr_array_index (self->caches, i);
+      if (cache->widget != GTK_WIDGET (glassed))
+        continue;
+      if (!do_glass)
+        return FALSE;
+
+      allocate_glass_widget (
+          self, cache->widget, g_ptr_array_index (self->glass_widgets, i),
+          &rrect, &cache->bounds,
+          gtk_widget_get_baseline (GTK_WIDGET (self)));
+      gtk_widget_queue_draw (GTK_WIDGET (self));
+      return TRUE;
+    }
+
+  return !do_glass;
+}
+
+/* Runs once GTK laid out the tree, so the slots are never allocated from
+   within the size_allocate () of a descendant */
+static void
+after_layout_cb (PastryGlassRoot *self,
+                 GdkFrameClock   *frame_clock)
+{
+  gboolean rebuild = FALSE;
+
+  if (self->pending->len == 0)
+    return;
+
+  for (guint i = 0; i < self->pending->len; i++)
+    {
+      GtkWidget *glassed = NULL;
+
+      glassed = g_ptr_array_index (self->pending, i);
+
+      /* It may have moved to another root in the meantime */
+      if (gtk_widget_get_ancestor (glassed, PASTRY_TYPE_GLASS_ROOT) != GTK_WIDGET (self))
+        continue;
+      if (!update_glassed (self, PASTRY_GLASSED (glassed)))
+        rebuild = TRUE;
+    }
+  g_ptr_array_set_size (self->pending, 0);
+
+  /* The frame clock runs the layout phase again for this */
+  if (rebuild)
+    {
+      gtk_widget_queue_allocate (GTK_WIDGET (self));
+      gtk_widget_queue_draw (GTK_WIDGET (self));
+    }
+}
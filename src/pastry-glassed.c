@@ -22,8 +22,7 @@
 
 #include "pastry-config.h"
 
-#include "pastry-glass-root.h"
-#include "pastry-glassed.h"
+#include "pastry-glass-root-private.h"
 
 G_DEFINE_INTERFACE (PastryGlassed, pastry_glassed, GTK_TYPE_WIDGET)
 
@@ -54,11 +53,19 @@ pastry_glassed_real_snapshot_overlay (PastryGlassed *self,
   return;
 }
 
+static gboolean
+pastry_glassed_real_snapshot_mask (PastryGlassed *self,
+                                   GtkSnapshot   *snapshot)
+{
+  return FALSE;
+}
+
 static void
 pastry_glassed_default_init (PastryGlassedInterface *iface)
 {
   iface->place_glass      = pastry_glassed_real_place_glass;
   iface->snapshot_overlay = pastry_glassed_real_snapshot_overlay;
+  iface->snapshot_mask    = pastry_glassed_real_snapshot_mask;
 }
 
 gboolean
@@ -88,6 +95,21 @@ pastry_glassed_snapshot_overlay (PastryGlassed *self,
       snapshot);
 }
 
+gboolean
+pastry_glassed_snapshot_mask (PastryGlassed *self,
+                              GtkSnapshot   *snapshot)
+{
+  gboolean ret = FALSE;
+
+  g_return_val_if_fail (PASTRY_IS_GLASSED (self), FALSE);
+  g_return_val_if_fail (GTK_IS_SNAPSHOT (snapshot), FALSE);
+
+  ret = PASTRY_GLASSED_GET_IFACE (self)->snapshot_mask (
+      self,
+      snapshot);
+  return ret;
+}
+
 void
 pastry_glassed_queue_draw (PastryGlassed *self)
 {
@@ -106,3 +128,20 @@ pastry_glassed_queue_draw (PastryGlassed *self)
   gtk_widget_queue_allocate (glass_root);
   gtk_widget_queue_draw (glass_root);
 }
+
+void
+pastry_glassed_update_glass (PastryGlassed *self)
+{
+  GtkWidget *glass_root = NULL;
+
+  g_return_if_fail (PASTRY_IS_GLASSED (self));
+
+  /* Without a root there is no glass to update */
+  glass_root = gtk_widget_get_ancestor (GTK_WIDGET (self), PASTRY_TYPE_GLASS_ROOT);
+  if (glass_root == NULL)
+    return;
+
+  /* Only the slot of @self is re-placed once layout is done, unless it
+     gained or lost its glass */
+  pastry_glass_root_queue_update_glassed (PASTRY_GLASS_ROOT (glass_root), self);
+}
@@ -42,6 +42,9 @@ struct _PastryGlassedInterface
 
   void (*snapshot_overlay) (PastryGlassed *self,
                             GtkSnapshot   *snapshot);
+
+  gboolean (*snapshot_mask) (PastryGlassed *self,
+                             GtkSnapshot   *snapshot);
 };
 
 LIBPASTRY_AVAILABLE_IN_ALL
@@ -54,8 +57,17 @@ void
 pastry_glassed_snapshot_overlay (PastryGlassed *self,
                                  GtkSnapshot   *snapshot);
 
+LIBPASTRY_AVAILABLE_IN_ALL
+gboolean
+pastry_glassed_snapshot_mask (PastryGlassed *self,
+                              GtkSnapshot   *snapshot);
+
 LIBPASTRY_AVAILABLE_IN_ALL
 void
 pastry_glassed_queue_draw (PastryGlassed *self);
 
+LIBPASTRY_AVAILABLE_IN_ALL
+void
+pastry_glassed_update_glass (PastryGlassed *self);
+
 G_END_DECLS
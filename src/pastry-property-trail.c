@@ -39,6 +39,8 @@ enum
   PROP_OBJECT,
   PROP_TRAIL,
   PROP_RESOLVED,
+  PROP_COALESCE,
+  PROP_WEAK,
 
   LAST_PROP
 };
@@ -52,6 +54,33 @@ enum
 };
 static guint signals[LAST_SIGNAL];
 
+static guint notify_signal_id = 0;
+
+/* Trails handed out by pastry_property_trail_new_shared (), keyed by their
+   root object and path. The table doesn't own the trails, they remove
+   themselves when finalized */
+static GHashTable *shared_trails = NULL;
+
+/* One link of a trail, compiled once when the trail is set. The pspec is
+   cached for the type of the last object seen at this depth, which is almost
+   always the same type */
+typedef struct
+{
+  const char *name;
+  GType       owner;
+  GParamSpec *pspec;
+} Step;
+
+/* A target property mirroring the terminal value of the trail. The last value
+   pushed is kept so unchanged values never reach the target's setter */
+typedef struct
+{
+  GWeakRef      target;
+  GParamSpec   *pspec;
+  GBindingFlags flags;
+  GValue        last;
+} Binding;
+
 struct _PastryPropertyTrail
 {
   GObject parent_instance;
@@ -59,18 +88,71 @@ struct _PastryPropertyTrail
   GObject    *object;
   GListModel *trail;
   GObject    *resolved;
+  GWeakRef    resolved_ref;
+  GValue      value;
+  gboolean    coalesce;
+  gboolean    weak;
 
+  GArray    *steps;
   GPtrArray *objects;
+  GArray    *handlers;
+  GPtrArray *bindings;
+
+  guint dirty_depth;
+  guint dirty_idle;
+
+  char *shared_key;
 };
 G_DEFINE_FINAL_TYPE (PastryPropertyTrail, pastry_property_trail, G_TYPE_OBJECT)
 
 static void
-dig (PastryPropertyTrail *self);
+dig (PastryPropertyTrail *self,
+     guint                from);
 
 static void
 clear (PastryPropertyTrail *self,
        guint                from);
 
+static void
+compile_steps (PastryPropertyTrail *self);
+
+static GParamSpec *
+lookup_step (Step    *step,
+             GObject *object);
+
+static void
+cancel_dirty (PastryPropertyTrail *self);
+
+static void
+mark_dirty (PastryPropertyTrail *self,
+            guint                depth);
+
+static void
+push_bindings (PastryPropertyTrail *self);
+
+static gboolean
+push_binding (PastryPropertyTrail *self,
+              Binding             *binding);
+
+static void
+binding_free (Binding *binding);
+
+static void
+track_object (PastryPropertyTrail *self,
+              GObject             *object,
+              gulong               handler);
+
+static void
+untrack_object (PastryPropertyTrail *self,
+                guint                depth);
+
+static void
+object_finalized_cb (PastryPropertyTrail *self,
+                     GObject             *where_the_object_was);
+
+static gboolean
+dirty_idle_cb (PastryPropertyTrail *self);
+
 static void
 property_changed_cb (PastryPropertyTrail *self,
                      GParamSpec          *pspec,
@@ -81,17 +163,40 @@ dispose (GObject *object)
 {
   PastryPropertyTrail *self = PASTRY_PROPERTY_TRAIL (object);
 
+  cancel_dirty (self);
   clear (self, 0);
 
+  if (G_IS_VALUE (&self->value))
+    g_value_unset (&self->value);
   pastry_clear_pointers (
       &self->object, g_object_unref,
       &self->trail, g_object_unref,
       &self->resolved, g_object_unref,
       NULL);
+  g_array_set_size (self->steps, 0);
+  g_ptr_array_set_size (self->bindings, 0);
 
   G_OBJECT_CLASS (pastry_property_trail_parent_class)->dispose (object);
 }
 
+static void
+finalize (GObject *object)
+{
+  PastryPropertyTrail *self = PASTRY_PROPERTY_TRAIL (object);
+
+  /* The table owns the key */
+  if (self->shared_key != NULL)
+    g_hash_table_remove (shared_trails, self->shared_key);
+
+  g_array_unref (self->steps);
+  g_ptr_array_unref (self->objects);
+  g_array_unref (self->handlers);
+  g_ptr_array_unref (self->bindings);
+  g_weak_ref_clear (&self->resolved_ref);
+
+  G_OBJECT_CLASS (pastry_property_trail_parent_class)->finalize (object);
+}
+
 static void
 get_property (GObject    *object,
               guint       prop_id,
@@ -111,6 +216,12 @@ get_property (GObject    *object,
     case PROP_RESOLVED:
       g_value_take_object (value, pastry_property_trail_dup_resolved (self));
       break;
+    case PROP_COALESCE:
+      g_value_set_boolean (value, pastry_property_trail_get_coalesce (self));
+      break;
+    case PROP_WEAK:
+      g_value_set_boolean (value, pastry_property_trail_get_weak (self));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
     }
@@ -132,6 +243,12 @@ set_property (GObject      *object,
     case PROP_TRAIL:
       pastry_property_trail_set_trail (self, g_value_get_object (value));
       break;
+    case PROP_COALESCE:
+      pastry_property_trail_set_coalesce (self, g_value_get_boolean (value));
+      break;
+    case PROP_WEAK:
+      pastry_property_trail_set_weak (self, g_value_get_boolean (value));
+      break;
     case PROP_RESOLVED:
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
@@ -146,6 +263,7 @@ pastry_property_trail_class_init (PastryPropertyTrailClass *klass)
   object_class->set_property = set_property;
   object_class->get_property = get_property;
   object_class->dispose      = dispose;
+  object_class->finalize     = finalize;
 
   /**
    * PastryPropertyTrail:object:
@@ -184,6 +302,36 @@ pastry_property_trail_class_init (PastryPropertyTrailClass *klass)
           G_TYPE_OBJECT,
           G_PARAM_READABLE | G_PARAM_STATIC_STRINGS | G_PARAM_EXPLICIT_NOTIFY);
 
+  /**
+   * PastryPropertyTrail:coalesce:
+   *
+   * Whether notifications along the trail are batched. When %TRUE, any number
+   * of notifications in a row only resolve the trail and emit
+   * [signal@Pastry.PropertyTrail::changed] once, right before the next frame
+   * is drawn.
+   */
+  props[PROP_COALESCE] =
+      g_param_spec_boolean (
+          "coalesce",
+          NULL, NULL,
+          FALSE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | G_PARAM_EXPLICIT_NOTIFY);
+
+  /**
+   * PastryPropertyTrail:weak:
+   *
+   * Whether the objects along the trail and the resolved object are only
+   * weakly referenced. When %TRUE, the trail doesn't keep them alive, and
+   * resolves again from the depth of any object that gets finalized. The root
+   * object is always strongly referenced.
+   */
+  props[PROP_WEAK] =
+      g_param_spec_boolean (
+          "weak",
+          NULL, NULL,
+          FALSE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | G_PARAM_EXPLICIT_NOTIFY);
+
   g_object_class_install_properties (object_class, LAST_PROP, props);
 
   /**
@@ -208,12 +356,20 @@ pastry_property_trail_class_init (PastryPropertyTrailClass *klass)
       signals[SIGNAL_CHANGED],
       G_TYPE_FROM_CLASS (klass),
       g_cclosure_marshal_VOID__OBJECTv);
+
+  notify_signal_id = g_signal_lookup ("notify", G_TYPE_OBJECT);
 }
 
 static void
 pastry_property_trail_init (PastryPropertyTrail *self)
 {
-  self->objects = g_ptr_array_new_with_free_func (g_object_unref);
+  self->dirty_depth = G_MAXUINT;
+
+  self->steps    = g_array_new (FALSE, TRUE, sizeof (Step));
+  self->objects  = g_ptr_array_new ();
+  self->handlers = g_array_new (FALSE, TRUE, sizeof (gulong));
+  self->bindings = g_ptr_array_new_with_free_func ((GDestroyNotify) binding_free);
+  g_weak_ref_init (&self->resolved_ref, NULL);
 }
 
 /**
@@ -260,6 +416,81 @@ pastry_property_trail_new (gpointer    object,
       NULL);
 }
 
+/**
+ * pastry_property_trail_new_shared:
+ * @object: The root object to track
+ * @property: The first property
+ * @...: optionally more properties, followed by %NULL
+ *
+ * Gets a `PastryPropertyTrail` for @object and the given properties, shared
+ * with every other caller that asked for the same root object and path.
+ *
+ * Sharing means the notify handlers along the path are only connected once
+ * and the trail is only resolved once per change, no matter how many
+ * subscribers there are. Shared trails always coalesce their notifications,
+ * see [property@Pastry.PropertyTrail:coalesce].
+ *
+ * The returned trail is read-only for its subscribers, it must not be
+ * modified with [method@Pastry.PropertyTrail.set_object],
+ * [method@Pastry.PropertyTrail.set_trail] or
+ * [method@Pastry.PropertyTrail.set_coalesce].
+ *
+ * Returns: (transfer full): a shared `PastryPropertyTrail` object.
+ */
+PastryPropertyTrail *
+pastry_property_trail_new_shared (gpointer    object,
+                                  const char *property,
+                                  ...)
+{
+  va_list var_args                = { 0 };
+  g_autoptr (GString) key         = NULL;
+  g_autoptr (GtkStringList) trail = NULL;
+  PastryPropertyTrail *self       = NULL;
+
+  g_return_val_if_fail (G_IS_OBJECT (object), NULL);
+  g_return_val_if_fail (property != NULL, NULL);
+
+  key   = g_string_new (NULL);
+  trail = gtk_string_list_new (NULL);
+
+  g_string_append_printf (key, "%p/%s", object, property);
+  gtk_string_list_append (trail, property);
+
+  va_start (var_args, property);
+  for (;;)
+    {
+      const char *extra_property = NULL;
+
+      extra_property = va_arg (var_args, const char *);
+      if (extra_property != NULL)
+        {
+          g_string_append_printf (key, "/%s", extra_property);
+          gtk_string_list_append (trail, extra_property);
+        }
+      else
+        break;
+    }
+  va_end (var_args);
+
+  if (shared_trails == NULL)
+    shared_trails = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+  self = g_hash_table_lookup (shared_trails, key->str);
+  if (self != NULL)
+    return g_object_ref (self);
+
+  self = g_object_new (
+      PASTRY_TYPE_PROPERTY_TRAIL,
+      "object", object,
+      "trail", trail,
+      "coalesce", TRUE,
+      NULL);
+  self->shared_key = g_string_free (g_steal_pointer (&key), FALSE);
+  g_hash_table_insert (shared_trails, self->shared_key, self);
+
+  return self;
+}
+
 /**
  * pastry_property_trail_set_object:
  * @self: a `PastryPropertyTrail`
@@ -272,6 +503,7 @@ pastry_property_trail_set_object (PastryPropertyTrail *self,
                                   GObject             *object)
 {
   g_return_if_fail (PASTRY_IS_PROPERTY_TRAIL (self));
+  g_return_if_fail (self->shared_key == NULL);
   g_return_if_fail (object == NULL || G_IS_OBJECT (object));
 
   if (object == self->object)
@@ -280,8 +512,9 @@ pastry_property_trail_set_object (PastryPropertyTrail *self,
   if (object != NULL)
     self->object = g_object_ref (object);
 
+  cancel_dirty (self);
   clear (self, 0);
-  dig (self);
+  dig (self, 0);
 
   g_object_notify_by_pspec (G_OBJECT (self), props[PROP_OBJECT]);
 }
@@ -313,6 +546,7 @@ pastry_property_trail_set_trail (PastryPropertyTrail *self,
                                  GListModel          *trail)
 {
   g_return_if_fail (PASTRY_IS_PROPERTY_TRAIL (self));
+  g_return_if_fail (self->shared_key == NULL);
   g_return_if_fail (trail == NULL || G_IS_LIST_MODEL (trail));
 
   if (trail == self->trail)
@@ -321,8 +555,10 @@ pastry_property_trail_set_trail (PastryPropertyTrail *self,
   if (trail != NULL)
     self->trail = g_object_ref (trail);
 
+  compile_steps (self);
+  cancel_dirty (self);
   clear (self, 0);
-  dig (self);
+  dig (self, 0);
 
   g_object_notify_by_pspec (G_OBJECT (self), props[PROP_TRAIL]);
 }
@@ -342,6 +578,122 @@ pastry_property_trail_get_trail (PastryPropertyTrail *self)
   return self->trail;
 }
 
+/**
+ * pastry_property_trail_set_coalesce:
+ * @self: a `PastryPropertyTrail`
+ * @coalesce: whether to batch notifications
+ *
+ * Sets whether notifications along the trail are batched into a single
+ * emission of [signal@Pastry.PropertyTrail::changed] per frame.
+ */
+void
+pastry_property_trail_set_coalesce (PastryPropertyTrail *self,
+                                    gboolean             coalesce)
+{
+  g_return_if_fail (PASTRY_IS_PROPERTY_TRAIL (self));
+  g_return_if_fail (self->shared_key == NULL);
+
+  coalesce = !!coalesce;
+  if (coalesce == self->coalesce)
+    return;
+  self->coalesce = coalesce;
+
+  if (!coalesce && self->dirty_idle != 0)
+    {
+      guint depth = 0;
+
+      /* Flush what was batched so far */
+      depth = self->dirty_depth;
+      cancel_dirty (self);
+      dig (self, depth < self->objects->len ? depth : 0);
+    }
+
+  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_COALESCE]);
+}
+
+/**
+ * pastry_property_trail_get_coalesce:
+ * @self: a `PastryPropertyTrail`
+ *
+ * Gets whether notifications along the trail are batched.
+ *
+ * Returns: whether @self coalesces notifications
+ */
+gboolean
+pastry_property_trail_get_coalesce (PastryPropertyTrail *self)
+{
+  g_return_val_if_fail (PASTRY_IS_PROPERTY_TRAIL (self), FALSE);
+  return self->coalesce;
+}
+
+/**
+ * pastry_property_trail_set_weak:
+ * @self: a `PastryPropertyTrail`
+ * @weak: whether to only weakly reference objects along the trail
+ *
+ * Sets whether the objects along the trail and the resolved object are only
+ * weakly referenced.
+ */
+void
+pastry_property_trail_set_weak (PastryPropertyTrail *self,
+                                gboolean             weak)
+{
+  g_return_if_fail (PASTRY_IS_PROPERTY_TRAIL (self));
+
+  weak = !!weak;
+  if (weak == self->weak)
+    return;
+
+  /* Drop the references with the mode they were taken in */
+  cancel_dirty (self);
+  clear (self, 0);
+  self->weak = weak;
+  dig (self, 0);
+
+  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_WEAK]);
+}
+
+/**
+ * pastry_property_trail_get_weak:
+ * @self: a `PastryPropertyTrail`
+ *
+ * Gets whether the objects along the trail are only weakly referenced.
+ *
+ * Returns: whether @self uses weak references
+ */
+gboolean
+pastry_property_trail_get_weak (PastryPropertyTrail *self)
+{
+  g_return_val_if_fail (PASTRY_IS_PROPERTY_TRAIL (self), FALSE);
+  return self->weak;
+}
+
+/**
+ * pastry_property_trail_get_value:
+ * @self: a `PastryPropertyTrail`
+ *
+ * Gets the value of the last property in the trail, as of the last time the
+ * trail was resolved. This is cached, so reading it never goes through the
+ * property system.
+ *
+ * If [property@Pastry.PropertyTrail:weak] is %TRUE and the last property holds
+ * an object, the value isn't cached so the object isn't kept alive, unless
+ * the trail has bindings created with [method@Pastry.PropertyTrail.bind].
+ *
+ * Returns: (nullable) (transfer none): the value of the last property, or
+ *   %NULL if the trail can't be fully resolved
+ */
+const GValue *
+pastry_property_trail_get_value (PastryPropertyTrail *self)
+{
+  g_return_val_if_fail (PASTRY_IS_PROPERTY_TRAIL (self), NULL);
+
+  if (G_IS_VALUE (&self->value))
+    return &self->value;
+  else
+    return NULL;
+}
+
 /**
  * pastry_property_trail_dup_resolved:
  * @self: a `PastryPropertyTrail`
@@ -359,41 +711,178 @@ pastry_property_trail_dup_resolved (PastryPropertyTrail *self)
 {
   g_return_val_if_fail (PASTRY_IS_PROPERTY_TRAIL (self), NULL);
 
-  if (self->resolved != NULL)
+  if (self->weak)
+    return g_weak_ref_get (&self->resolved_ref);
+  else if (self->resolved != NULL)
     return g_object_ref (self->resolved);
   else
     return NULL;
 }
 
+/**
+ * pastry_property_trail_bind:
+ * @self: a `PastryPropertyTrail`
+ * @target: (type GObject.Object): the object to push values into
+ * @property: the name of the property on @target
+ * @flags: flags for the binding
+ *
+ * Mirrors the value of the last property in the trail onto @property of
+ * @target. This is a lighter alternative to connecting to
+ * [signal@Pastry.PropertyTrail::changed] and setting the property by hand:
+ * the cached value is pushed directly, and the setter of @target is only
+ * called when the value actually changed. While the trail can't be fully
+ * resolved, @property is reset to its default value.
+ *
+ * If the types of the two properties differ, the value is converted with
+ * g_value_transform(). Only %G_BINDING_SYNC_CREATE and
+ * %G_BINDING_INVERT_BOOLEAN are supported in @flags; without
+ * %G_BINDING_SYNC_CREATE, @target is left untouched until the next change.
+ *
+ * @self only holds a weak reference on @target, the binding is dropped once
+ * @target is finalized.
+ */
+void
+pastry_property_trail_bind (PastryPropertyTrail *self,
+                            gpointer             target,
+                            const char          *property,
+                            GBindingFlags        flags)
+{
+  GParamSpec *pspec   = NULL;
+  Binding    *binding = NULL;
+
+  g_return_if_fail (PASTRY_IS_PROPERTY_TRAIL (self));
+  g_return_if_fail (G_IS_OBJECT (target));
+  g_return_if_fail (property != NULL);
+  g_return_if_fail ((flags & ~(G_BINDING_SYNC_CREATE | G_BINDING_INVERT_BOOLEAN)) == 0);
+
+  pspec = g_object_class_find_property (G_OBJECT_GET_CLASS (target), property);
+  if (pspec == NULL)
+    {
+      g_critical ("Property \"%s\" doesn't exist on class %s",
+                  property, G_OBJECT_TYPE_NAME (target));
+      return;
+    }
+  g_return_if_fail ((pspec->flags & G_PARAM_WRITABLE) != 0);
+  g_return_if_fail ((pspec->flags & G_PARAM_CONSTRUCT_ONLY) == 0);
+  g_return_if_fail (!(flags & G_BINDING_INVERT_BOOLEAN) ||
+                    pspec->value_type == G_TYPE_BOOLEAN);
+
+  binding        = g_new0 (Binding, 1);
+  binding->pspec = g_param_spec_ref (pspec);
+  binding->flags = flags;
+  g_weak_ref_init (&binding->target, target);
+  g_value_init (&binding->last, pspec->value_type);
+  g_ptr_array_add (self->bindings, binding);
+
+  /* Weak trails only cache object values while they have bindings, so it
+     may be missing from the last time the trail was resolved */
+  if (self->weak &&
+      !G_IS_VALUE (&self->value) &&
+      self->steps->len > 0 &&
+      self->objects->len == self->steps->len)
+    {
+      Step    *step = NULL;
+      GObject *last = NULL;
+
+      step = &g_array_index (self->steps, Step, self->steps->len - 1);
+      last = g_ptr_array_index (self->objects, self->objects->len - 1);
+
+      g_value_init (&self->value, step->pspec->value_type);
+      g_object_get_property (last, step->pspec->name, &self->value);
+    }
+
+  if (flags & G_BINDING_SYNC_CREATE)
+    /* Start from the current value, so the first push is skipped if it
+       already matches */
+    g_object_get_property (target, pspec->name, &binding->last);
+  else
+    {
+      /* Only record where the trail is at, so the next real change is pushed */
+      const GValue *value = NULL;
+
+      value = pastry_property_trail_get_value (self);
+      if (value == NULL ||
+          !g_value_type_transformable (G_VALUE_TYPE (value), pspec->value_type) ||
+          !g_value_transform (value, &binding->last))
+        g_param_value_set_default (pspec, &binding->last);
+      else if (flags & G_BINDING_INVERT_BOOLEAN)
+        g_value_set_boolean (&binding->last, !g_value_get_boolean (&binding->last));
+    }
+
+  if ((flags & G_BINDING_SYNC_CREATE) &&
+      !push_binding (self, binding))
+    g_ptr_array_remove_fast (self->bindings, binding);
+}
+
+/**
+ * pastry_property_trail_unbind:
+ * @self: a `PastryPropertyTrail`
+ * @target: (type GObject.Object): the object passed to
+ *   [method@Pastry.PropertyTrail.bind]
+ * @property: the name of the bound property on @target
+ *
+ * Removes a binding created with [method@Pastry.PropertyTrail.bind].
+ */
+void
+pastry_property_trail_unbind (PastryPropertyTrail *self,
+                              gpointer             target,
+                              const char          *property)
+{
+  g_return_if_fail (PASTRY_IS_PROPERTY_TRAIL (self));
+  g_return_if_fail (G_IS_OBJECT (target));
+  g_return_if_fail (property != NULL);
+
+  for (guint i = 0; i < self->bindings->len; i++)
+    {
+      Binding *binding          = NULL;
+      g_autoptr (GObject) other = NULL;
+
+      binding = g_ptr_array_index (self->bindings, i);
+      other   = g_weak_ref_get (&binding->target);
+      if (other == target &&
+          g_strcmp0 (binding->pspec->name, property) == 0)
+        {
+          g_ptr_array_remove_index_fast (self->bindings, i);
+          return;
+        }
+    }
+
+  g_critical ("Property \"%s\" of %s %p isn't bound to this trail",
+              property, G_OBJECT_TYPE_NAME (target), target);
+}
+
+/* Resolves the trail starting at depth @from, reusing the objects already
+   tracked above it */
 static void
-dig (PastryPropertyTrail *self)
+dig (PastryPropertyTrail *self,
+     guint                from)
 {
   GType parent_prop_type     = G_TYPE_NONE;
   g_autoptr (GObject) object = NULL;
-  guint n_items              = 0;
+
+  if (G_IS_VALUE (&self->value))
+    g_value_unset (&self->value);
 
   if (self->object == NULL ||
-      self->trail == NULL)
+      self->steps->len == 0)
     {
       clear (self, 0);
       goto done;
     }
 
-  object = g_object_ref (self->object);
+  g_assert (from == 0 || from < self->objects->len);
+  if (from == 0)
+    object = g_object_ref (self->object);
+  else
+    object = g_object_ref (g_ptr_array_index (self->objects, from));
 
-  n_items = g_list_model_get_n_items (self->trail);
-  for (guint i = 0; i < n_items; i++)
+  for (guint i = from; i < self->steps->len; i++)
     {
-      g_autoptr (GtkStringObject) string = NULL;
-      const char *property               = NULL;
-      g_autoptr (GTypeClass) class       = NULL;
-      GParamSpec *pspec                  = NULL;
+      Step       *step  = NULL;
+      GParamSpec *pspec = NULL;
 
-      string   = g_list_model_get_item (self->trail, i);
-      property = gtk_string_object_get_string (string);
-
-      class = g_type_class_ref (G_OBJECT_TYPE (object));
-      pspec = g_object_class_find_property (G_OBJECT_CLASS (class), property);
+      step  = &g_array_index (self->steps, Step, i);
+      pspec = lookup_step (step, object);
       if (pspec != NULL)
         {
           gboolean setup = TRUE;
@@ -413,33 +902,54 @@ dig (PastryPropertyTrail *self)
 
           if (setup)
             {
-              g_autofree char *spec = NULL;
-
-              spec = g_strdup_printf ("notify::%s", property);
-              g_signal_connect_swapped (object, spec, G_CALLBACK (property_changed_cb), self);
-
-              g_ptr_array_add (self->objects, g_object_ref (object));
+              gulong handler = 0;
+
+              handler = g_signal_connect_closure_by_id (
+                  object, notify_signal_id,
+                  g_param_spec_get_name_quark (pspec),
+                  g_cclosure_new_swap (G_CALLBACK (property_changed_cb), self, NULL),
+                  FALSE);
+              track_object (self, object, handler);
             }
 
           if (g_type_is_a (pspec->value_type, G_TYPE_OBJECT))
             {
-              g_autoptr (GObject) tmp = NULL;
+              GValue value = G_VALUE_INIT;
 
-              g_object_get (object, property, &tmp, NULL);
+              g_value_init (&value, pspec->value_type);
+              g_object_get_property (object, pspec->name, &value);
               g_clear_object (&object);
-              object = g_steal_pointer (&tmp);
+              object = g_value_dup_object (&value);
+              /* Bound targets hold on to the value anyway */
+              if (i == self->steps->len - 1 &&
+                  (!self->weak || self->bindings->len > 0))
+                {
+                  g_value_init (&self->value, pspec->value_type);
+                  g_value_copy (&value, &self->value);
+                }
+              g_value_unset (&value);
 
               if (object == NULL)
-                break;
+                {
+                  /* Objects deeper than here are no longer on the trail */
+                  clear (self, i + 1);
+                  break;
+                }
             }
           else
             {
-              if (i != n_items - 1)
+              if (i != self->steps->len - 1)
                 {
                   g_critical ("Property \"%s\" is not of an object gtype on class %s",
-                              property, G_OBJECT_TYPE_NAME (object));
+                              step->name, G_OBJECT_TYPE_NAME (object));
                   g_clear_object (&object);
                 }
+              else
+                {
+                  g_value_init (&self->value, pspec->value_type);
+                  g_object_get_property (object, pspec->name, &self->value);
+                }
+              clear (self, i + 1);
               break;
             }
         }
@@ -449,17 +959,25 @@ dig (PastryPropertyTrail *self)
             /* Don't complain if the property was an interface, since the trail
                may be targeting a specific object type */
             g_critical ("Property \"%s\" doesn't exist on class %s",
-                        property, G_OBJECT_TYPE_NAME (object));
+                        step->name, G_OBJECT_TYPE_NAME (object));
           g_clear_object (&object);
+          clear (self, i);
           break;
         }
     }
 
 done:
   g_clear_object (&self->resolved);
+  g_weak_ref_set (&self->resolved_ref, NULL);
   if (object != NULL)
-    self->resolved = g_object_ref (object);
+    {
+      if (self->weak)
+        g_weak_ref_set (&self->resolved_ref, object);
+      else
+        self->resolved = g_object_ref (object);
+    }
 
+  push_bindings (self);
   g_signal_emit (self, signals[SIGNAL_CHANGED], 0, object);
   g_object_notify_by_pspec (G_OBJECT (self), props[PROP_RESOLVED]);
 }
@@ -469,13 +987,118 @@ clear (PastryPropertyTrail *self,
        guint                from)
 {
   for (guint i = from; i < self->objects->len; i++)
+    untrack_object (self, i);
+  g_ptr_array_set_size (self->objects, from);
+  g_array_set_size (self->handlers, from);
+}
+
+static void
+push_bindings (PastryPropertyTrail *self)
+{
+  /* Walk backwards so dead bindings can be removed in place */
+  for (guint i = self->bindings->len; i > 0; i--)
     {
-      GObject *object = NULL;
+      /* A target may have unbound others while being set */
+      if (i > self->bindings->len)
+        continue;
+      if (!push_binding (self, g_ptr_array_index (self->bindings, i - 1)))
+        g_ptr_array_remove_index_fast (self->bindings, i - 1);
+    }
+}
 
-      object = g_ptr_array_index (self->objects, i);
-      g_signal_handlers_disconnect_by_func (object, property_changed_cb, self);
+/* Returns %FALSE if the target is gone and the binding should be dropped */
+static gboolean
+push_binding (PastryPropertyTrail *self,
+              Binding             *binding)
+{
+  g_autoptr (GObject) target = NULL;
+  GValue value               = G_VALUE_INIT;
+
+  target = g_weak_ref_get (&binding->target);
+  if (target == NULL)
+    return FALSE;
+
+  g_value_init (&value, binding->pspec->value_type);
+  if (!G_IS_VALUE (&self->value) ||
+      !g_value_type_transformable (G_VALUE_TYPE (&self->value), binding->pspec->value_type) ||
+      !g_value_transform (&self->value, &value))
+    g_param_value_set_default (binding->pspec, &value);
+  else if (binding->flags & G_BINDING_INVERT_BOOLEAN)
+    g_value_set_boolean (&value, !g_value_get_boolean (&value));
+
+  g_param_value_validate (binding->pspec, &value);
+  if (g_param_values_cmp (binding->pspec, &value, &binding->last) != 0)
+    {
+      /* Record it first, the target's handlers may unbind us */
+      g_value_copy (&value, &binding->last);
+      g_object_set_property (target, binding->pspec->name, &value);
     }
-  g_ptr_array_set_size (self->objects, from);
+  g_value_unset (&value);
+
+  return TRUE;
+}
+
+static void
+binding_free (Binding *binding)
+{
+  g_weak_ref_clear (&binding->target);
+  g_param_spec_unref (binding->pspec);
+  g_value_unset (&binding->last);
+  g_free (binding);
+}
+
+/* The handler id is kept per depth so disconnecting never has to scan the
+   handlers of busy objects that many trails are connected to */
+static void
+track_object (PastryPropertyTrail *self,
+              GObject             *object,
+              gulong               handler)
+{
+  if (self->weak)
+    g_object_weak_ref (object, (GWeakNotify) object_finalized_cb, self);
+  else
+    g_object_ref (object);
+
+  g_ptr_array_add (self->objects, object);
+  g_array_append_val (self->handlers, handler);
+}
+
+static void
+untrack_object (PastryPropertyTrail *self,
+                guint                depth)
+{
+  GObject *object  = NULL;
+  gulong   handler = 0;
+
+  object  = g_ptr_array_index (self->objects, depth);
+  handler = g_array_index (self->handlers, gulong, depth);
+
+  g_signal_handler_disconnect (object, handler);
+  if (self->weak)
+    g_object_weak_unref (object, (GWeakNotify) object_finalized_cb, self);
+  else
+    g_object_unref (object);
+}
+
+static void
+object_finalized_cb (PastryPropertyTrail *self,
+                     GObject             *where_the_object_was)
+{
+  guint depth = 0;
+
+  if (!g_ptr_array_find (self->objects, where_the_object_was, &depth))
+    return;
+
+  /* The finalized object already lost its handlers, only the deeper objects
+     still need to be let go of */
+  for (guint i = depth + 1; i < self->objects->len; i++)
+    untrack_object (self, i);
+  g_ptr_array_set_size (self->objects, depth);
+  g_array_set_size (self->handlers, depth);
+
+  /* Don't resolve while the object is being finalized, the parent may still
+     be in the middle of letting go of it */
+  mark_dirty (self, depth > 0 ? depth - 1 : 0);
 }
 
 static void
@@ -483,5 +1106,91 @@ property_changed_cb (PastryPropertyTrail *self,
                      GParamSpec          *pspec,
                      GObject             *instance)
 {
-  dig (self);
+  guint depth = 0;
+
+  /* Everything above the object that notified is unaffected, so only the
+     suffix of the trail starting at its depth is resolved again */
+  if (!g_ptr_array_find (self->objects, instance, &depth))
+    depth = 0;
+
+  if (self->coalesce)
+    mark_dirty (self, depth);
+  else
+    dig (self, depth);
+}
+
+static void
+mark_dirty (PastryPropertyTrail *self,
+            guint                depth)
+{
+  self->dirty_depth = MIN (self->dirty_depth, depth);
+
+  /* Runs before GDK's layout and paint, so consumers that queue a draw from
+     the changed signal still make it into the coming frame */
+  if (self->dirty_idle == 0)
+    self->dirty_idle = g_idle_add_full (
+        G_PRIORITY_HIGH_IDLE + 10,
+        (GSourceFunc) dirty_idle_cb,
+        self, NULL);
+}
+
+static gboolean
+dirty_idle_cb (PastryPropertyTrail *self)
+{
+  guint depth = 0;
+
+  depth             = self->dirty_depth;
+  self->dirty_idle  = 0;
+  self->dirty_depth = G_MAXUINT;
+
+  /* Depths below a cleared link are gone, start over in that case */
+  dig (self, depth < self->objects->len ? depth : 0);
+  return G_SOURCE_REMOVE;
+}
+
+static void
+cancel_dirty (PastryPropertyTrail *self)
+{
+  if (self->dirty_idle != 0)
+    g_source_remove (self->dirty_idle);
+  self->dirty_idle  = 0;
+  self->dirty_depth = G_MAXUINT;
+}
+
+static void
+compile_steps (PastryPropertyTrail *self)
+{
+  guint n_items = 0;
+
+  g_array_set_size (self->steps, 0);
+  if (self->trail == NULL)
+    return;
+
+  n_items = g_list_model_get_n_items (self->trail);
+  for (guint i = 0; i < n_items; i++)
+    {
+      g_autoptr (GtkStringObject) string = NULL;
+      Step step                          = { 0 };
+
+      string    = g_list_model_get_item (self->trail, i);
+      step.name = g_intern_string (gtk_string_object_get_string (string));
+      g_array_append_val (self->steps, step);
+    }
+}
+
+static GParamSpec *
+lookup_step (Step    *step,
+             GObject *object)
+{
+  GType type = G_TYPE_INVALID;
+
+  type = G_OBJECT_TYPE (object);
+  if (type != step->owner)
+    {
+      /* The instance keeps its class alive, no need to ref it */
+      step->owner = type;
+      step->pspec = pastry_find_property (type, step->name);
+    }
+
+  return step->pspec;
 }
@@ -40,6 +40,13 @@ pastry_property_trail_new (gpointer    object,
                            const char *property,
                            ...);
 
+LIBPASTRY_AVAILABLE_IN_ALL
+G_GNUC_NULL_TERMINATED
+PastryPropertyTrail *
+pastry_property_trail_new_shared (gpointer    object,
+                                  const char *property,
+                                  ...);
+
 LIBPASTRY_AVAILABLE_IN_ALL
 void
 pastry_property_trail_set_object (PastryPropertyTrail *self,
@@ -56,8 +63,40 @@ LIBPASTRY_AVAILABLE_IN_ALL
 GListModel *
 pastry_property_trail_get_trail (PastryPropertyTrail *self);
 
+LIBPASTRY_AVAILABLE_IN_ALL
+void
+pastry_property_trail_set_coalesce (PastryPropertyTrail *self,
+                                    gboolean             coalesce);
+LIBPASTRY_AVAILABLE_IN_ALL
+gboolean
+pastry_property_trail_get_coalesce (PastryPropertyTrail *self);
+
+LIBPASTRY_AVAILABLE_IN_ALL
+void
+pastry_property_trail_set_weak (PastryPropertyTrail *self,
+                                gboolean             weak);
+LIBPASTRY_AVAILABLE_IN_ALL
+gboolean
+pastry_property_trail_get_weak (PastryPropertyTrail *self);
+
+LIBPASTRY_AVAILABLE_IN_ALL
+void
+pastry_property_trail_bind (PastryPropertyTrail *self,
+                            gpointer             target,
+                            const char          *property,
+                            GBindingFlags        flags);
+LIBPASTRY_AVAILABLE_IN_ALL
+void
+pastry_property_trail_unbind (PastryPropertyTrail *self,
+                              gpointer             target,
+                              const char          *property);
+
 LIBPASTRY_AVAILABLE_IN_ALL
 gpointer
 pastry_property_trail_dup_resolved (PastryPropertyTrail *self);
 
+LIBPASTRY_AVAILABLE_IN_ALL
+const GValue *
+pastry_property_trail_get_value (PastryPropertyTrail *self);
+
 G_END_DECLS
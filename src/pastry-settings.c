@@ -57,11 +57,12 @@ struct _PastrySettings
 
     GtkCssProvider *light;
     GtkCssProvider *dark;
-    GtkCssProvider *hc_light;
-    GtkCssProvider *hc_dark;
+    guint           prefetch_idle;
 
-    GDBusProxy *settings_portal;
-    gboolean    portal_wants_dark;
+    GDBusProxy   *settings_portal;
+    GCancellable *portal_cancellable;
+    gboolean      portal_wants_dark;
+    gboolean      portal_changed;
 
     GtkCssProvider *applied_css;
 
@@ -77,9 +78,18 @@ G_DEFINE_FINAL_TYPE (PastrySettings, pastry_settings, G_TYPE_OBJECT)
 static PastrySettings *
 init_default (void);
 
+#define CSS_LIGHT_RESOURCE "/org/gtk/libgtk/theme/Pastry/gtk.css"
+#define CSS_DARK_RESOURCE  "/org/gtk/libgtk/theme/Pastry/gtk-dark.css"
 static void
 init_css (PastrySettings *self);
 
+static GtkCssProvider *
+ensure_css (GtkCssProvider **provider,
+            const char      *resource);
+
+static gboolean
+prefetch_css_cb (PastrySettings *self);
+
 /* Copied with modifications from libadwaita */
 #define PORTAL_BUS_NAME           "org.freedesktop.portal.Desktop"
 #define PORTAL_OBJECT_PATH        "/org/freedesktop/portal/desktop"
@@ -88,6 +98,16 @@ init_css (PastrySettings *self);
 static void
 init_portal (PastrySettings *self);
 
+static void
+portal_proxy_ready_cb (GObject      *source_object,
+                       GAsyncResult *result,
+                       gpointer      user_data);
+
+static void
+portal_read_cb (GObject      *source_object,
+                GAsyncResult *result,
+                gpointer      user_data);
+
 static void
 init_manette (PastrySettings *self);
 
@@ -105,11 +125,12 @@ is_dark (GVariant *variant);
 
 /* Copied with modifications from libadwaita */
 static gboolean
-read_setting (PastrySettings *self,
-              const char     *schema,
-              const char     *name,
-              const char     *type,
-              GVariant      **out);
+unpack_setting (GVariant    *ret,
+                GError      *local_error,
+                const char  *schema,
+                const char  *name,
+                const char  *type,
+                GVariant   **out);
 
 static void
 apply_css (PastrySettings *self);
@@ -154,6 +175,8 @@ dispose (GObject *object)
 {
   PastrySettings *self = PASTRY_SETTINGS (object);
 
+  if (self->default_state.portal_cancellable != NULL)
+    g_cancellable_cancel (self->default_state.portal_cancellable);
   if (self->default_state.settings_portal != NULL)
     g_signal_handlers_disconnect_by_func (
         self->default_state.settings_portal,
@@ -191,15 +214,19 @@ dispose (GObject *object)
     gtk_style_context_remove_provider_for_display (
         self->default_state.display,
         GTK_STYLE_PROVIDER (self->default_state.applied_css));
+  if (self->default_state.prefetch_idle != 0)
+    {
+      g_source_remove (self->default_state.prefetch_idle);
+      self->default_state.prefetch_idle = 0;
+    }
 
   pastry_clear_pointers (
       &self->theme, g_object_unref,
       &self->default_state.display, g_object_unref,
       &self->default_state.light, g_object_unref,
       &self->default_state.dark, g_object_unref,
-      &self->default_state.hc_light, g_object_unref,
-      &self->default_state.hc_dark, g_object_unref,
       &self->default_state.settings_portal, g_object_unref,
+      &self->default_state.portal_cancellable, g_object_unref,
       &self->default_state.manette.monitor, g_object_unref,
       &self->default_state.manette.devices, g_ptr_array_unref,
       NULL);
@@ -270,7 +297,6 @@ pastry_settings_class_init (PastrySettingsClass *klass)
 static void
 pastry_settings_init (PastrySettings *self)
 {
-  init_portal (self);
 }
 
 /**
@@ -301,13 +327,17 @@ pastry_settings_get_default (void)
 void
 pastry_copy_accent_rgba (GdkRGBA *rgba)
 {
-  PastrySettings    *settings = NULL;
-  PastryVisualTheme *theme    = NULL;
+  static PastryPath *path             = NULL;
+  PastrySettings    *settings         = NULL;
+  g_autoptr (PastryVisualTheme) theme = NULL;
 
   g_return_if_fail (rgba != NULL);
 
+  if (g_once_init_enter_pointer (&path))
+    g_once_init_leave_pointer (&path, pastry_path_new ("theme", "visual-theme", NULL));
+
   settings = pastry_settings_get_default ();
-  theme    = pastry_get_object (settings, "theme", "visual-theme", NULL);
+  theme    = pastry_path_get_object (path, settings);
 
   if (theme != NULL)
     pastry_visual_theme_copy_accent_rgba (theme, rgba);
@@ -399,62 +429,132 @@ init_css (PastrySettings *self)
   /* TODO: listen to creation of displays */
   display = gdk_display_get_default ();
 
-  self->default_state.display  = g_object_ref (display);
-  self->default_state.light    = gtk_css_provider_new ();
-  self->default_state.dark     = gtk_css_provider_new ();
-  self->default_state.hc_light = gtk_css_provider_new ();
-  self->default_state.hc_dark  = gtk_css_provider_new ();
-
-  gtk_css_provider_load_from_resource (
-      self->default_state.light,
-      "/org/gtk/libgtk/theme/Pastry/gtk.css");
-  gtk_css_provider_load_from_resource (
-      self->default_state.dark,
-      "/org/gtk/libgtk/theme/Pastry/gtk-dark.css");
-  gtk_css_provider_load_from_resource (
-      self->default_state.hc_light,
-      "/org/gtk/libgtk/theme/Pastry/gtk-hc.css");
-  gtk_css_provider_load_from_resource (
-      self->default_state.hc_dark,
-      "/org/gtk/libgtk/theme/Pastry/gtk-hc-dark.css");
-  g_info ("Loaded stylesheets");
+  self->default_state.display = g_object_ref (display);
 
+  /* Only the variant in use is parsed here, see apply_css () */
   apply_css (self);
 }
 
+/* The stylesheets are large, so each one is only parsed the first time it's
+   needed */
+static GtkCssProvider *
+ensure_css (GtkCssProvider **provider,
+            const char      *resource)
+{
+  if (*provider == NULL)
+    {
+      *provider = gtk_css_provider_new ();
+      gtk_css_provider_load_from_resource (*provider, resource);
+      g_info ("Loaded stylesheet %s", resource);
+    }
+
+  return *provider;
+}
+
+/* Parses the other light/dark variant while idle, so switching the color
+   scheme later doesn't stall a frame */
+static gboolean
+prefetch_css_cb (PastrySettings *self)
+{
+  self->default_state.prefetch_idle = 0;
+
+  ensure_css (&self->default_state.light, CSS_LIGHT_RESOURCE);
+  ensure_css (&self->default_state.dark, CSS_DARK_RESOURCE);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Nothing here blocks, the light stylesheet applied by init_css () stays
+   until the portal replies with the color scheme */
 static void
 init_portal (PastrySettings *self)
 {
-  g_autoptr (GError) error     = NULL;
-  g_autoptr (GVariant) variant = NULL;
-  gboolean was_read            = FALSE;
+  self->default_state.portal_cancellable = g_cancellable_new ();
 
-  self->default_state.settings_portal = g_dbus_proxy_new_for_bus_sync (
+  g_dbus_proxy_new_for_bus (
       G_BUS_TYPE_SESSION,
-      G_DBUS_PROXY_FLAGS_NONE,
+      G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES,
       NULL,
       PORTAL_BUS_NAME,
       PORTAL_OBJECT_PATH,
       PORTAL_SETTINGS_INTERFACE,
-      NULL,
-      &error);
+      self->default_state.portal_cancellable,
+      portal_proxy_ready_cb,
+      self);
+}
 
-  if (self->default_state.settings_portal == NULL)
+static void
+portal_proxy_ready_cb (GObject      *source_object,
+                       GAsyncResult *result,
+                       gpointer      user_data)
+{
+  PastrySettings *self         = NULL;
+  g_autoptr (GError) error     = NULL;
+  g_autoptr (GDBusProxy) proxy = NULL;
+
+  proxy = g_dbus_proxy_new_for_bus_finish (result, &error);
+  if (proxy == NULL)
     {
-      g_debug ("Settings portal not found: %s", error->message);
+      /* @self is gone if we were cancelled */
+      if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        g_debug ("Settings portal not found: %s", error->message);
       return;
     }
+  self = PASTRY_SETTINGS (user_data);
 
-  was_read = read_setting (self, "org.freedesktop.appearance",
-                           "color-scheme", "u", &variant);
-  if (was_read)
-    self->default_state.portal_wants_dark = is_dark (variant);
-  else
-    g_debug ("Could not read color scheme info from portal");
+  self->default_state.settings_portal = g_steal_pointer (&proxy);
 
+  /* Listen before reading, so a change racing with the read isn't lost */
   g_signal_connect_swapped (
       self->default_state.settings_portal, "g-signal",
       G_CALLBACK (portal_changed_cb), self);
+
+  g_dbus_proxy_call (
+      self->default_state.settings_portal,
+      "Read",
+      g_variant_new ("(ss)", "org.freedesktop.appearance", "color-scheme"),
+      G_DBUS_CALL_FLAGS_NONE,
+      -1,
+      self->default_state.portal_cancellable,
+      portal_read_cb,
+      self);
+}
+
+static void
+portal_read_cb (GObject      *source_object,
+                GAsyncResult *result,
+                gpointer      user_data)
+{
+  PastrySettings *self           = NULL;
+  g_autoptr (GError) local_error = NULL;
+  g_autoptr (GVariant) ret       = NULL;
+  g_autoptr (GVariant) variant   = NULL;
+  gboolean was_read              = FALSE;
+  gboolean wants_dark            = FALSE;
+
+  ret = g_dbus_proxy_call_finish (G_DBUS_PROXY (source_object), result, &local_error);
+  if (g_error_matches (local_error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    return;
+  self = PASTRY_SETTINGS (user_data);
+
+  was_read = unpack_setting (ret, local_error, "org.freedesktop.appearance",
+                             "color-scheme", "u", &variant);
+  if (!was_read)
+    {
+      g_debug ("Could not read color scheme info from portal");
+      return;
+    }
+
+  /* A SettingChanged signal that arrived in the meantime is more recent */
+  if (self->default_state.portal_changed)
+    return;
+
+  wants_dark = is_dark (variant);
+  if (wants_dark != self->default_state.portal_wants_dark)
+    {
+      self->default_state.portal_wants_dark = wants_dark;
+      apply_css (self);
+    }
 }
 
 static void
@@ -520,6 +620,7 @@ portal_changed_cb (PastrySettings *self,
       g_strcmp0 (name, "color-scheme") == 0)
     {
       self->default_state.portal_wants_dark = is_dark (value);
+      self->default_state.portal_changed    = TRUE;
       apply_css (self);
     }
 }
@@ -544,27 +645,17 @@ is_dark (GVariant *variant)
 }
 
 static gboolean
-read_setting (PastrySettings *self,
-              const char     *schema,
-              const char     *name,
-              const char     *type,
-              GVariant      **out)
+unpack_setting (GVariant    *ret,
+                GError      *local_error,
+                const char  *schema,
+                const char  *name,
+                const char  *type,
+                GVariant   **out)
 {
-  g_autoptr (GError) local_error = NULL;
-  g_autoptr (GVariant) ret       = NULL;
-  g_autoptr (GVariant) child     = NULL;
-  g_autoptr (GVariant) child2    = NULL;
+  g_autoptr (GVariant) child  = NULL;
+  g_autoptr (GVariant) child2 = NULL;
   g_autoptr (GVariantType) out_type;
 
-  ret = g_dbus_proxy_call_sync (
-      self->default_state.settings_portal,
-      "Read",
-      g_variant_new ("(ss)", schema, name),
-      G_DBUS_CALL_FLAGS_NONE,
-      G_MAXINT,
-      NULL,
-      &local_error);
-
   if (local_error != NULL)
     {
       if (local_error->domain == G_DBUS_ERROR &&
@@ -613,14 +704,26 @@ apply_css (PastrySettings *self)
   g_clear_object (&self->default_state.applied_css);
 
   if (self->default_state.portal_wants_dark)
-    self->default_state.applied_css = g_object_ref (self->default_state.dark);
+    self->default_state.applied_css = g_object_ref (
+        ensure_css (&self->default_state.dark, CSS_DARK_RESOURCE));
   else
-    self->default_state.applied_css = g_object_ref (self->default_state.light);
+    self->default_state.applied_css = g_object_ref (
+        ensure_css (&self->default_state.light, CSS_LIGHT_RESOURCE));
 
   gtk_style_context_add_provider_for_display (
       self->default_state.display,
       GTK_STYLE_PROVIDER (self->default_state.applied_css),
       GTK_STYLE_PROVIDER_PRIORITY_SETTINGS);
+
+  /* Lower than GDK's redraw priority, so this waits until the first frames
+     have been drawn */
+  if (self->default_state.prefetch_idle == 0 &&
+      (self->default_state.light == NULL ||
+       self->default_state.dark == NULL))
+    self->default_state.prefetch_idle = g_idle_add_full (
+        G_PRIORITY_LOW,
+        (GSourceFunc) prefetch_css_cb,
+        self, NULL);
 }
 
 static void
@@ -54,6 +54,8 @@ struct _PastrySpinner
   double modulated;
 
   PastryPropertyTrail *accent_trail;
+  gulong               accent_changed;
+  GdkRGBA              accent;
 };
 G_DEFINE_FINAL_TYPE (PastrySpinner, pastry_spinner, GTK_TYPE_WIDGET)
 
@@ -67,8 +69,9 @@ dispose (GObject *object)
 {
   PastrySpinner *self = PASTRY_SPINNER (object);
 
-  g_signal_handlers_disconnect_by_func (
-      self->accent_trail, accent_changed_cb, self);
+  /* The trail is shared with every other spinner, so don't scan its
+     handlers */
+  g_clear_signal_handler (&self->accent_changed, self->accent_trail);
 
   pastry_clear_pointers (
       &self->accent_trail, g_object_unref,
@@ -148,7 +151,7 @@ snapshot (GtkWidget   *widget,
   width  = gtk_widget_get_width (GTK_WIDGET (self));
   height = gtk_widget_get_height (GTK_WIDGET (self));
 
-  pastry_copy_accent_rgba (&accent);
+  accent = self->accent;
 
   gtk_snapshot_save (snapshot);
   gtk_snapshot_translate (
@@ -255,12 +258,13 @@ pastry_spinner_init (PastrySpinner *self)
 
   gtk_widget_add_tick_callback (GTK_WIDGET (self), (GtkTickCallback) tick_cb, NULL, NULL);
 
-  self->accent_trail = pastry_property_trail_new (
+  self->accent_trail = pastry_property_trail_new_shared (
       pastry_settings_get_default (),
       "theme", "visual-theme", "accent", NULL);
-  g_signal_connect_swapped (
+  self->accent_changed = g_signal_connect_swapped (
       self->accent_trail, "changed",
       G_CALLBACK (accent_changed_cb), self);
+  accent_changed_cb (self, NULL, self->accent_trail);
 }
 
 /**
@@ -339,5 +343,15 @@ accent_changed_cb (PastrySpinner       *self,
                    PastryTheme         *theme,
                    PastryPropertyTrail *trail)
 {
+  const GValue *value  = NULL;
+  const char   *accent = NULL;
+
+  /* Parsed once per change here so snapshot () only copies the color */
+  value = pastry_property_trail_get_value (trail);
+  if (value != NULL && G_VALUE_HOLDS_STRING (value))
+    accent = g_value_get_string (value);
+  if (accent == NULL || !gdk_rgba_parse (&self->accent, accent))
+    self->accent = (GdkRGBA){ 0 };
+
   gtk_widget_queue_draw (GTK_WIDGET (self));
 }
@@ -0,0 +1,348 @@
+/* pastry-static-layer.c
+ *
+ * Copyright 2025 Eva M
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * PastryStaticLayer:
+ *
+ * Caches the rendering of a mostly static child widget, such as a wallpaper
+ * or large illustration, in a `GdkTexture`.
+ *
+ * The texture is only re-rendered when the child queues a draw or the layer
+ * changes size, so widgets drawn on top of it like `PastryGlassRoot` or
+ * spinners composite against a single texture node every frame. Anything the
+ * child draws outside of the layer's allocation is clipped.
+ */
+
+#define G_LOG_DOMAIN "PASTRY::STATIC-LAYER"
+
+#include "pastry-config.h"
+
+#include "pastry-static-layer.h"
+#include "pastry-util.h"
+
+enum
+{
+  PROP_0,
+
+  PROP_CHILD,
+
+  LAST_PROP
+};
+static GParamSpec *props[LAST_PROP] = { 0 };
+
+struct _PastryStaticLayer
+{
+  GtkWidget parent_instance;
+
+  GtkWidget *child;
+
+  GskRenderNode *node;
+  GdkTexture    *texture;
+  int            width;
+  int            height;
+  int            scale;
+};
+G_DEFINE_FINAL_TYPE (PastryStaticLayer, pastry_static_layer, GTK_TYPE_WIDGET)
+
+static void
+clear_cache (PastryStaticLayer *self);
+
+static gboolean
+same_child_node (GskRenderNode *node,
+                 GskRenderNode *cached);
+
+static void
+dispose (GObject *object)
+{
+  PastryStaticLayer *self = PASTRY_STATIC_LAYER (object);
+
+  clear_cache (self);
+
+  pastry_clear_pointers (
+      &self->child, gtk_widget_unparent,
+      NULL);
+
+  G_OBJECT_CLASS (pastry_static_layer_parent_class)->dispose (object);
+}
+
+static void
+get_property (GObject    *object,
+              guint       prop_id,
+              GValue     *value,
+              GParamSpec *pspec)
+{
+  PastryStaticLayer *self = PASTRY_STATIC_LAYER (object);
+
+  switch (prop_id)
+    {
+    case PROP_CHILD:
+      g_value_set_object (value, pastry_static_layer_get_child (self));
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+set_property (GObject      *object,
+              guint         prop_id,
+              const GValue *value,
+              GParamSpec   *pspec)
+{
+  PastryStaticLayer *self = PASTRY_STATIC_LAYER (object);
+
+  switch (prop_id)
+    {
+    case PROP_CHILD:
+      pastry_static_layer_set_child (self, g_value_get_object (value));
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+measure (GtkWidget     *widget,
+         GtkOrientation orientation,
+         int            for_size,
+         int           *minimum,
+         int           *natural,
+         int           *minimum_baseline,
+         int           *natural_baseline)
+{
+  PastryStaticLayer *self = PASTRY_STATIC_LAYER (widget);
+
+  if (self->child != NULL)
+    gtk_widget_measure (
+        self->child, orientation,
+        for_size, minimum, natural,
+        minimum_baseline, natural_baseline);
+}
+
+static void
+size_allocate (GtkWidget *widget,
+               int        width,
+               int        height,
+               int        baseline)
+{
+  PastryStaticLayer *self = PASTRY_STATIC_LAYER (widget);
+
+  if (self->child != NULL && gtk_widget_should_layout (self->child))
+    gtk_widget_allocate (self->child, width, height, baseline, NULL);
+}
+
+static void
+snapshot (GtkWidget   *widget,
+          GtkSnapshot *snapshot)
+{
+  PastryStaticLayer *self                = PASTRY_STATIC_LAYER (widget);
+  int                width               = 0;
+  int                height              = 0;
+  int                scale               = 0;
+  g_autoptr (GtkSnapshot) child_snapshot = NULL;
+  g_autoptr (GskRenderNode) node         = NULL;
+
+  if (self->child == NULL)
+    return;
+
+  width  = gtk_widget_get_width (widget);
+  height = gtk_widget_get_height (widget);
+  scale  = gtk_widget_get_scale_factor (widget);
+  if (width <= 0 || height <= 0)
+    return;
+
+  child_snapshot = gtk_snapshot_new ();
+  gtk_widget_snapshot_child (widget, self->child, child_snapshot);
+  node = gtk_snapshot_to_node (child_snapshot);
+  if (node == NULL)
+    {
+      clear_cache (self);
+      return;
+    }
+
+  /* GTK keeps handing out the same render node for the child until it queues
+     a draw, so an identical node means the texture is still up to date */
+  if (self->texture == NULL ||
+      !same_child_node (node, self->node) ||
+      width != self->width ||
+      height != self->height ||
+      scale != self->scale)
+    {
+      GtkNative   *native                = NULL;
+      GskRenderer *renderer              = NULL;
+      g_autoptr (GskTransform) transform = NULL;
+      g_autoptr (GskRenderNode) scaled   = NULL;
+
+      native = gtk_widget_get_native (widget);
+      if (native != NULL)
+        renderer = gtk_native_get_renderer (native);
+      if (renderer == NULL)
+        {
+          clear_cache (self);
+          gtk_snapshot_append_node (snapshot, node);
+          return;
+        }
+
+      if (scale != 1)
+        {
+          transform = gsk_transform_scale (NULL, scale, scale);
+          scaled    = gsk_transform_node_new (node, transform);
+        }
+      else
+        scaled = gsk_render_node_ref (node);
+
+      clear_cache (self);
+      self->texture = gsk_renderer_render_texture (
+          renderer, scaled,
+          &GRAPHENE_RECT_INIT (0.0, 0.0, width * scale, height * scale));
+      self->node   = gsk_render_node_ref (node);
+      self->width  = width;
+      self->height = height;
+      self->scale  = scale;
+    }
+
+  gtk_snapshot_append_texture (
+      snapshot, self->texture,
+      &GRAPHENE_RECT_INIT (0.0, 0.0, width, height));
+}
+
+static void
+unrealize (GtkWidget *widget)
+{
+  PastryStaticLayer *self = PASTRY_STATIC_LAYER (widget);
+
+  /* The texture may belong to the renderer going away */
+  clear_cache (self);
+
+  GTK_WIDGET_CLASS (pastry_static_layer_parent_class)->unrealize (widget);
+}
+
+static void
+pastry_static_layer_class_init (PastryStaticLayerClass *klass)
+{
+  GObjectClass   *object_class = G_OBJECT_CLASS (klass);
+  GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (klass);
+
+  object_class->set_property = set_property;
+  object_class->get_property = get_property;
+  object_class->dispose      = dispose;
+
+  /**
+   * PastryStaticLayer:child:
+   *
+   * The child widget
+   */
+  props[PROP_CHILD] =
+      g_param_spec_object (
+          "child",
+          NULL, NULL,
+          GTK_TYPE_WIDGET,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | G_PARAM_EXPLICIT_NOTIFY);
+
+  g_object_class_install_properties (object_class, LAST_PROP, props);
+
+  widget_class->measure       = measure;
+  widget_class->size_allocate = size_allocate;
+  widget_class->snapshot      = snapshot;
+  widget_class->unrealize     = unrealize;
+
+  gtk_widget_class_set_css_name (widget_class, "pastry-static-layer");
+}
+
+static void
+pastry_static_layer_init (PastryStaticLayer *self)
+{
+  gtk_widget_set_overflow (GTK_WIDGET (self), GTK_OVERFLOW_HIDDEN);
+}
+
+/**
+ * pastry_static_layer_set_child:
+ * @self: a `PastryStaticLayer`
+ * @child: the child widget
+ *
+ * Sets the child widget
+ */
+void
+pastry_static_layer_set_child (PastryStaticLayer *self,
+                               GtkWidget         *child)
+{
+  g_return_if_fail (PASTRY_IS_STATIC_LAYER (self));
+
+  g_return_if_fail (child == NULL || GTK_IS_WIDGET (child));
+
+  if (self->child == child)
+    return;
+
+  if (child != NULL)
+    g_return_if_fail (gtk_widget_get_parent (child) == NULL);
+
+  g_clear_pointer (&self->child, gtk_widget_unparent);
+  self->child = child;
+
+  if (child != NULL)
+    gtk_widget_set_parent (child, GTK_WIDGET (self));
+
+  clear_cache (self);
+  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_CHILD]);
+}
+
+/**
+ * pastry_static_layer_get_child
+ * @self: a `PastryStaticLayer`
+ *
+ * Gets the child widget of @self.
+ *
+ * Returns: (nullable) (transfer none): the child widget of @self
+ */
+GtkWidget *
+pastry_static_layer_get_child (PastryStaticLayer *self)
+{
+  g_return_val_if_fail (PASTRY_IS_STATIC_LAYER (self), NULL);
+  return self->child;
+}
+
+static void
+clear_cache (PastryStaticLayer *self)
+{
+  pastry_clear_pointers (
+      &self->node, gsk_render_node_unref,
+      &self->texture, g_object_unref,
+      NULL);
+}
+
+/* gtk_widget_snapshot_child () wraps the child's node in a fresh transform
+   node every frame when the child has a transform, e.g. from CSS margins or
+   a non-fill alignment, so look inside it */
+static gboolean
+same_child_node (GskRenderNode *node,
+                 GskRenderNode *cached)
+{
+  if (node == cached)
+    return TRUE;
+  if (cached == NULL ||
+      gsk_render_node_get_node_type (node) != GSK_TRANSFORM_NODE ||
+      gsk_render_node_get_node_type (cached) != GSK_TRANSFORM_NODE)
+    return FALSE;
+
+  return gsk_transform_node_get_child (node) == gsk_transform_node_get_child (cached) &&
+         gsk_transform_equal (
+             gsk_transform_node_get_transform (node),
+             gsk_transform_node_get_transform (cached));
+}
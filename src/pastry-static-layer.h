@@ -0,0 +1,45 @@
+/* pastry-static-layer.h
+ *
+ * Copyright 2025 Eva M
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#ifndef LIBPASTRY_INSIDE
+#error "Only <libpastry.h> can be included directly."
+#endif
+
+#include "libpastry-version-macros.h"
+
+#include <gtk/gtk.h>
+
+G_BEGIN_DECLS
+
+#define PASTRY_TYPE_STATIC_LAYER (pastry_static_layer_get_type ())
+G_DECLARE_FINAL_TYPE (PastryStaticLayer, pastry_static_layer, PASTRY, STATIC_LAYER, GtkWidget)
+
+LIBPASTRY_AVAILABLE_IN_ALL
+void
+pastry_static_layer_set_child (PastryStaticLayer *self,
+                               GtkWidget         *child);
+
+LIBPASTRY_AVAILABLE_IN_ALL
+GtkWidget *
+pastry_static_layer_get_child (PastryStaticLayer *self);
+
+G_END_DECLS
@@ -24,6 +24,46 @@
 
 #include "pastry-util.h"
 
+/* One hop of a compiled path. The pspec is cached for the type of the last
+   object seen at this hop */
+typedef struct
+{
+  const char *name;
+  GType       owner;
+  GParamSpec *pspec;
+} PathStep;
+
+struct _PastryPath
+{
+  guint    n_steps;
+  PathStep steps[];
+};
+
+typedef struct
+{
+  GType       type;
+  const char *name;
+} PropertyKey;
+
+G_LOCK_DEFINE_STATIC (properties);
+static GHashTable *properties = NULL;
+
+static guint
+property_key_hash (gconstpointer ptr);
+
+static gboolean
+property_key_equal (gconstpointer a,
+                    gconstpointer b);
+
+static GParamSpec *
+lookup_path_step (PathStep *step,
+                  GObject  *object);
+
+static void
+get_property_fast (GObject    *object,
+                   GParamSpec *pspec,
+                   GValue     *value);
+
 void
 pastry_clear_pointers (gpointer first_ptr,
                        gpointer free_func,
@@ -151,3 +191,231 @@ pastry_get_valist (gpointer    object,
   *value = cur_value;
   return ret;
 }
+
+/* Like g_object_class_find_property (), but the result is cached per type and
+   name in a table of our own, so hot paths don't go through the global
+   GParamSpecPool lock and the walk up the type hierarchy */
+GParamSpec *
+pastry_find_property (GType       type,
+                      const char *property)
+{
+  PropertyKey key   = { 0 };
+  GParamSpec *pspec = NULL;
+
+  g_return_val_if_fail (G_TYPE_IS_OBJECT (type) || G_TYPE_IS_INTERFACE (type), NULL);
+  g_return_val_if_fail (property != NULL, NULL);
+
+  key.type = type;
+  key.name = g_intern_string (property);
+
+  G_LOCK (properties);
+  if (properties == NULL)
+    properties = g_hash_table_new_full (
+        property_key_hash, property_key_equal,
+        g_free, NULL);
+  else
+    pspec = g_hash_table_lookup (properties, &key);
+  G_UNLOCK (properties);
+
+  if (pspec != NULL)
+    return pspec;
+
+  if (G_TYPE_IS_INTERFACE (type))
+    {
+      gpointer iface = NULL;
+
+      iface = g_type_default_interface_peek (type);
+      if (iface != NULL)
+        pspec = g_object_interface_find_property (iface, key.name);
+    }
+  else
+    {
+      GObjectClass *klass = NULL;
+
+      klass = g_type_class_peek (type);
+      if (klass != NULL)
+        pspec = g_object_class_find_property (klass, key.name);
+    }
+
+  /* Pspecs live as long as their class, and classes are never unloaded */
+  if (pspec != NULL)
+    {
+      G_LOCK (properties);
+      g_hash_table_replace (properties, g_memdup2 (&key, sizeof (key)), pspec);
+      G_UNLOCK (properties);
+    }
+
+  return pspec;
+}
+
+/* Compiles a list of property names, like the ones passed to
+   pastry_get_object () and friends, so that it can be resolved with
+   pastry_path_get () any number of times without parsing it again */
+PastryPath *
+pastry_path_new (const char *property,
+                 ...)
+{
+  va_list     var_args = { 0 };
+  guint       n_steps  = 1;
+  PastryPath *path     = NULL;
+
+  g_return_val_if_fail (property != NULL, NULL);
+
+  va_start (var_args, property);
+  while (va_arg (var_args, const char *) != NULL)
+    n_steps++;
+  va_end (var_args);
+
+  path          = g_malloc0 (sizeof (PastryPath) + n_steps * sizeof (PathStep));
+  path->n_steps = n_steps;
+
+  path->steps[0].name = g_intern_string (property);
+  va_start (var_args, property);
+  for (guint i = 1; i < n_steps; i++)
+    path->steps[i].name = g_intern_string (va_arg (var_args, const char *));
+  va_end (var_args);
+
+  return path;
+}
+
+void
+pastry_path_free (PastryPath *path)
+{
+  g_free (path);
+}
+
+/* The equivalent of pastry_get_valist () for a compiled path. Intermediate
+   objects are read straight from their class, skipping the checks and the
+   transform g_object_get_property () goes through for every hop */
+gboolean
+pastry_path_get (PastryPath *path,
+                 gpointer    object,
+                 GValue     *value)
+{
+  GValue cur_value = G_VALUE_INIT;
+
+  g_return_val_if_fail (path != NULL, FALSE);
+  g_return_val_if_fail (G_IS_OBJECT (object), FALSE);
+  g_return_val_if_fail (value != NULL, FALSE);
+
+  if (G_IS_VALUE (value))
+    g_value_unset (value);
+
+  for (guint i = 0; i < path->n_steps; i++)
+    {
+      GObject    *cur_object = NULL;
+      GParamSpec *pspec      = NULL;
+
+      if (i == 0)
+        cur_object = object;
+      else if (G_VALUE_HOLDS (&cur_value, G_TYPE_OBJECT))
+        cur_object = g_value_get_object (&cur_value);
+      else
+        {
+          g_warning ("Cannot get property %s on object of type %s",
+                     path->steps[i].name, g_type_name (cur_value.g_type));
+          g_value_unset (&cur_value);
+          return FALSE;
+        }
+
+      if (cur_object == NULL)
+        {
+          g_value_unset (&cur_value);
+          return FALSE;
+        }
+
+      pspec = lookup_path_step (&path->steps[i], cur_object);
+      if (pspec == NULL)
+        {
+          /* The cached step doesn't keep track of why it failed, this path
+             is rare enough to just look it up again */
+          if (pastry_find_property (G_OBJECT_TYPE (cur_object), path->steps[i].name) != NULL)
+            g_warning ("Property \"%s\" isn't readable on class %s",
+                       path->steps[i].name, G_OBJECT_TYPE_NAME (cur_object));
+          else
+            g_warning ("Property \"%s\" doesn't exist on class %s",
+                       path->steps[i].name, G_OBJECT_TYPE_NAME (cur_object));
+          g_value_unset (&cur_value);
+          return FALSE;
+        }
+
+      if (i == path->n_steps - 1)
+        {
+          g_value_init (value, pspec->value_type);
+          get_property_fast (cur_object, pspec, value);
+        }
+      else
+        {
+          GValue tmp_value = G_VALUE_INIT;
+
+          /* The current value holds the ref on cur_object, keep it alive
+             until the next hop has been read */
+          g_value_init (&tmp_value, pspec->value_type);
+          get_property_fast (cur_object, pspec, &tmp_value);
+          if (G_IS_VALUE (&cur_value))
+            g_value_unset (&cur_value);
+          cur_value = tmp_value;
+        }
+    }
+
+  if (G_IS_VALUE (&cur_value))
+    g_value_unset (&cur_value);
+  return TRUE;
+}
+
+static guint
+property_key_hash (gconstpointer ptr)
+{
+  const PropertyKey *key = ptr;
+
+  return g_direct_hash (key->name) ^ (guint) key->type;
+}
+
+static gboolean
+property_key_equal (gconstpointer a,
+                    gconstpointer b)
+{
+  const PropertyKey *key_a = a;
+  const PropertyKey *key_b = b;
+
+  /* Names are interned */
+  return key_a->type == key_b->type &&
+         key_a->name == key_b->name;
+}
+
+static GParamSpec *
+lookup_path_step (PathStep *step,
+                  GObject  *object)
+{
+  GType type = G_TYPE_INVALID;
+
+  type = G_OBJECT_TYPE (object);
+  if (type != step->owner)
+    {
+      step->owner = type;
+      step->pspec = pastry_find_property (type, step->name);
+      if (step->pspec != NULL &&
+          !(step->pspec->flags & G_PARAM_READABLE))
+        step->pspec = NULL;
+    }
+
+  return step->pspec;
+}
+
+/* What g_object_get_property () boils down to once the pspec is known and
+   @value already has the property's exact type */
+static void
+get_property_fast (GObject    *object,
+                   GParamSpec *pspec,
+                   GValue     *value)
+{
+  GObjectClass *klass    = NULL;
+  GParamSpec   *redirect = NULL;
+
+  klass    = g_type_class_peek (pspec->owner_type);
+  redirect = g_param_spec_get_redirect_target (pspec);
+
+  klass->get_property (
+      object, pspec->param_id, value,
+      redirect != NULL ? redirect : pspec);
+}
@@ -96,4 +96,65 @@ _DEFINE_GETTER (gpointer, boxed, dup_boxed, NULL);
 
 #undef _DEFINE_GETTER
 
+GParamSpec *
+pastry_find_property (GType       type,
+                      const char *property);
+
+typedef struct _PastryPath PastryPath;
+
+G_GNUC_NULL_TERMINATED
+PastryPath *
+pastry_path_new (const char *property,
+                 ...);
+
+void
+pastry_path_free (PastryPath *path);
+
+gboolean
+pastry_path_get (PastryPath *path,
+                 gpointer    object,
+                 GValue     *value);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (PastryPath, pastry_path_free)
+
+#define _DEFINE_PATH_GETTER(_type, _func_type, _get, _orelse) \
+  G_GNUC_UNUSED                                               \
+  static inline _type                                         \
+  pastry_path_get_##_func_type (PastryPath *path,             \
+                                gpointer    object)           \
+  {                                                           \
+    GValue value = G_VALUE_INIT;                              \
+                                                              \
+    if (pastry_path_get (path, object, &value))               \
+      {                                                       \
+        _type tmp = (_orelse);                                \
+                                                              \
+        tmp = g_value_##_get (&value);                        \
+        g_value_unset (&value);                               \
+        return tmp;                                           \
+      }                                                       \
+    else                                                      \
+      return (_orelse);                                       \
+  }
+
+_DEFINE_PATH_GETTER (gchar, char, get_schar, 0);
+_DEFINE_PATH_GETTER (guchar, uchar, get_uchar, 0);
+_DEFINE_PATH_GETTER (gboolean, boolean, get_boolean, 0);
+_DEFINE_PATH_GETTER (gint, int, get_int, 0);
+_DEFINE_PATH_GETTER (guint, uint, get_uint, 0);
+_DEFINE_PATH_GETTER (glong, long, get_long, 0);
+_DEFINE_PATH_GETTER (gulong, ulong, get_ulong, 0);
+_DEFINE_PATH_GETTER (gint64, int64, get_int64, 0);
+_DEFINE_PATH_GETTER (guint64, uint64, get_uint64, 0);
+_DEFINE_PATH_GETTER (int, enum, get_enum, 0);
+_DEFINE_PATH_GETTER (int, flags, get_flags, 0);
+_DEFINE_PATH_GETTER (gfloat, float, get_float, 0.0);
+_DEFINE_PATH_GETTER (gdouble, double, get_double, 0.0);
+
+_DEFINE_PATH_GETTER (char *, string, dup_string, NULL);
+_DEFINE_PATH_GETTER (gpointer, object, dup_object, NULL);
+_DEFINE_PATH_GETTER (gpointer, boxed, dup_boxed, NULL);
+
+#undef _DEFINE_PATH_GETTER
+
 G_END_DECLS
@@ -0,0 +1,384 @@
+/* test-render-nodes.c
+ *
+ * Copyright 2025 Eva M
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/* Snapshots each widget and checks the size of the resulting render node
+   tree, so a change that silently multiplies the nodes emitted by a
+   snapshot () implementation fails here */
+
+#include <libpastry.h>
+
+#define WIDTH  400
+#define HEIGHT 300
+
+#define MAP_TIMEOUT_MS 5000
+
+typedef struct
+{
+  guint n_nodes;
+  guint depth;
+} NodeStats;
+
+typedef struct
+{
+  const char *name;
+  GtkWidget *(*build) (void);
+  guint max_nodes;
+  guint max_depth;
+} WidgetCase;
+
+static void
+collect_stats (GskRenderNode *node,
+               guint          depth,
+               NodeStats     *stats);
+
+static GskRenderNode *
+snapshot_widget (GtkWidget *widget);
+
+static gboolean
+map_timeout_cb (gboolean *timed_out);
+
+static void
+check_bounds (const char    *name,
+              GskRenderNode *node,
+              guint          max_nodes,
+              guint          max_depth);
+
+static GtkWidget *
+build_glass_root (guint n_frames);
+
+static GtkWidget *
+build_glass_root_8 (void);
+
+static GtkWidget *
+build_focus_overlay (void);
+
+static GtkWidget *
+build_annotation_overlay (void);
+
+static GtkWidget *
+build_spinner (void);
+
+static GtkWidget *
+build_grid_spinner (void);
+
+static const WidgetCase cases[] = {
+  { "glass-root", build_glass_root_8, 256, 32 },
+  { "focus-overlay", build_focus_overlay, 64, 24 },
+  { "annotation-overlay", build_annotation_overlay, 64, 24 },
+  { "spinner", build_spinner, 32, 12 },
+  { "grid-spinner", build_grid_spinner, 96, 12 },
+};
+
+static void
+test_no_display (void)
+{
+  g_test_skip ("No display available");
+}
+
+static void
+test_widget (gconstpointer data)
+{
+  const WidgetCase *widget_case  = data;
+  g_autoptr (GskRenderNode) node = NULL;
+
+  node = snapshot_widget (widget_case->build ());
+  if (node == NULL)
+    {
+      g_test_skip ("The widget could not be mapped");
+      return;
+    }
+
+  check_bounds (widget_case->name, node, widget_case->max_nodes, widget_case->max_depth);
+}
+
+/* The glass frames share the blur pass of their root, so each extra frame
+   must only add a bounded number of nodes */
+static void
+test_glass_root_scaling (void)
+{
+  g_autoptr (GskRenderNode) few  = NULL;
+  g_autoptr (GskRenderNode) many = NULL;
+  NodeStats few_stats            = { 0 };
+  NodeStats many_stats           = { 0 };
+
+  few  = snapshot_widget (build_glass_root (4));
+  many = snapshot_widget (build_glass_root (16));
+  if (few == NULL || many == NULL)
+    {
+      g_test_skip ("The widget could not be mapped");
+      return;
+    }
+
+  collect_stats (few, 1, &few_stats);
+  collect_stats (many, 1, &many_stats);
+
+  g_test_message ("glass-root: %u nodes with 4 frames, %u with 16",
+                  few_stats.n_nodes, many_stats.n_nodes);
+  g_assert_cmpuint (many_stats.n_nodes, >=, few_stats.n_nodes);
+  g_assert_cmpuint (many_stats.n_nodes - few_stats.n_nodes, <=, 12 * 16);
+  g_assert_cmpuint (many_stats.depth, ==, few_stats.depth);
+}
+
+int
+main (int   argc,
+      char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  if (!gtk_init_check ())
+    {
+      g_test_add_func ("/render-nodes/no-display", test_no_display);
+      return g_test_run ();
+    }
+  pastry_init ();
+
+  for (guint i = 0; i < G_N_ELEMENTS (cases); i++)
+    {
+      g_autofree char *path = NULL;
+
+      path = g_strdup_printf ("/render-nodes/%s", cases[i].name);
+      g_test_add_data_func (path, &cases[i], test_widget);
+    }
+  g_test_add_func ("/render-nodes/glass-root-scaling", test_glass_root_scaling);
+
+  return g_test_run ();
+}
+
+static void
+collect_stats (GskRenderNode *node,
+               guint          depth,
+               NodeStats     *stats)
+{
+  GskRenderNodeType type   = GSK_NOT_A_RENDER_NODE;
+  GskRenderNode    *child  = NULL;
+  GskRenderNode    *child2 = NULL;
+
+  stats->n_nodes++;
+  stats->depth = MAX (stats->depth, depth);
+
+  type = gsk_render_node_get_node_type (node);
+  if (type == GSK_CONTAINER_NODE)
+    {
+      for (guint i = 0; i < gsk_container_node_get_n_children (node); i++)
+        collect_stats (gsk_container_node_get_child (node, i), depth + 1, stats);
+      return;
+    }
+
+  if (type == GSK_TRANSFORM_NODE)
+    child = gsk_transform_node_get_child (node);
+  else if (type == GSK_OPACITY_NODE)
+    child = gsk_opacity_node_get_child (node);
+  else if (type == GSK_COLOR_MATRIX_NODE)
+    child = gsk_color_matrix_node_get_child (node);
+  else if (type == GSK_REPEAT_NODE)
+    child = gsk_repeat_node_get_child (node);
+  else if (type == GSK_CLIP_NODE)
+    child = gsk_clip_node_get_child (node);
+  else if (type == GSK_ROUNDED_CLIP_NODE)
+    child = gsk_rounded_clip_node_get_child (node);
+  else if (type == GSK_SHADOW_NODE)
+    child = gsk_shadow_node_get_child (node);
+  else if (type == GSK_BLUR_NODE)
+    child = gsk_blur_node_get_child (node);
+  else if (type == GSK_DEBUG_NODE)
+    child = gsk_debug_node_get_child (node);
+  else if (type == GSK_FILL_NODE)
+    child = gsk_fill_node_get_child (node);
+  else if (type == GSK_STROKE_NODE)
+    child = gsk_stroke_node_get_child (node);
+  else if (type == GSK_SUBSURFACE_NODE)
+    child = gsk_subsurface_node_get_child (node);
+  else if (type == GSK_COMPONENT_TRANSFER_NODE)
+    child = gsk_component_transfer_node_get_child (node);
+  else if (type == GSK_BLEND_NODE)
+    {
+      child  = gsk_blend_node_get_bottom_child (node);
+      child2 = gsk_blend_node_get_top_child (node);
+    }
+  else if (type == GSK_CROSS_FADE_NODE)
+    {
+      child  = gsk_cross_fade_node_get_start_child (node);
+      child2 = gsk_cross_fade_node_get_end_child (node);
+    }
+  else if (type == GSK_MASK_NODE)
+    {
+      child  = gsk_mask_node_get_source (node);
+      child2 = gsk_mask_node_get_mask (node);
+    }
+
+  if (child != NULL)
+    collect_stats (child, depth + 1, stats);
+  if (child2 != NULL)
+    collect_stats (child2, depth + 1, stats);
+}
+
+/* Returns %NULL if the window never got mapped, which happens with
+   headless backends that don't configure surfaces */
+static GskRenderNode *
+snapshot_widget (GtkWidget *widget)
+{
+  GtkWidget   *window                = NULL;
+  gboolean     timed_out             = FALSE;
+  guint        timeout               = 0;
+  GtkSnapshot *snapshot              = NULL;
+  g_autoptr (GdkPaintable) paintable = NULL;
+
+  window = gtk_window_new ();
+  gtk_window_set_default_size (GTK_WINDOW (window), WIDTH, HEIGHT);
+  gtk_window_set_child (GTK_WINDOW (window), widget);
+  gtk_window_present (GTK_WINDOW (window));
+
+  timeout = g_timeout_add (MAP_TIMEOUT_MS, (GSourceFunc) map_timeout_cb, &timed_out);
+  while (!timed_out &&
+         (!gtk_widget_get_mapped (widget) ||
+          gtk_widget_get_width (widget) == 0))
+    g_main_context_iteration (NULL, TRUE);
+  if (!timed_out)
+    g_source_remove (timeout);
+
+  if (timed_out)
+    {
+      gtk_window_destroy (GTK_WINDOW (window));
+      return NULL;
+    }
+
+  paintable = gtk_widget_paintable_new (widget);
+  snapshot  = gtk_snapshot_new ();
+  gdk_paintable_snapshot (
+      paintable, snapshot,
+      gtk_widget_get_width (widget),
+      gtk_widget_get_height (widget));
+
+  gtk_widget_paintable_set_widget (GTK_WIDGET_PAINTABLE (paintable), NULL);
+  gtk_window_destroy (GTK_WINDOW (window));
+
+  return gtk_snapshot_free_to_node (snapshot);
+}
+
+static gboolean
+map_timeout_cb (gboolean *timed_out)
+{
+  *timed_out = TRUE;
+  return G_SOURCE_REMOVE;
+}
+
+static void
+check_bounds (const char    *name,
+              GskRenderNode *node,
+              guint          max_nodes,
+              guint          max_depth)
+{
+  NodeStats stats = { 0 };
+
+  collect_stats (node, 1, &stats);
+  g_test_message ("%s: %u nodes, depth %u", name, stats.n_nodes, stats.depth);
+
+  if (stats.n_nodes > max_nodes || stats.depth > max_depth)
+    {
+      g_autofree char *basename = NULL;
+      g_autofree char *path     = NULL;
+
+      /* Keep the offending tree around, it can be opened with gtk4-node-editor */
+      basename = g_strdup_printf ("%s.node", name);
+      path     = g_build_filename (g_get_tmp_dir (), basename, NULL);
+      if (gsk_render_node_write_to_file (node, path, NULL))
+        g_test_message ("Wrote the render node of %s to %s", name, path);
+    }
+
+  g_assert_cmpuint (stats.n_nodes, <=, max_nodes);
+  g_assert_cmpuint (stats.depth, <=, max_depth);
+}
+
+static GtkWidget *
+build_glass_root (guint n_frames)
+{
+  GtkWidget *root = NULL;
+  GtkWidget *box  = NULL;
+
+  box = gtk_box_new (GTK_ORIENTATION_VERTICAL, 6);
+  for (guint i = 0; i < n_frames; i++)
+    {
+      g_autofree char *text  = NULL;
+      GtkWidget       *frame = NULL;
+
+      text  = g_strdup_printf ("Frame %u", i);
+      frame = g_object_new (PASTRY_TYPE_GLASS_FRAME, NULL);
+      pastry_glass_frame_set_child (PASTRY_GLASS_FRAME (frame), gtk_label_new (text));
+      gtk_box_append (GTK_BOX (box), frame);
+    }
+
+  /* Every frame needs a slot of its own */
+  root = g_object_new (
+      PASTRY_TYPE_GLASS_ROOT,
+      "capacity", n_frames,
+      NULL);
+  pastry_glass_root_set_child (PASTRY_GLASS_ROOT (root), box);
+
+  return root;
+}
+
+static GtkWidget *
+build_glass_root_8 (void)
+{
+  return build_glass_root (8);
+}
+
+static GtkWidget *
+build_focus_overlay (void)
+{
+  GtkWidget *overlay = NULL;
+
+  overlay = g_object_new (PASTRY_TYPE_FOCUS_OVERLAY, NULL);
+  pastry_focus_overlay_set_child (
+      PASTRY_FOCUS_OVERLAY (overlay),
+      gtk_button_new_with_label ("Focus"));
+
+  return overlay;
+}
+
+/* The annotation is glassed, so it lives under a root like in applications */
+static GtkWidget *
+build_annotation_overlay (void)
+{
+  GtkWidget *root    = NULL;
+  GtkWidget *overlay = NULL;
+
+  overlay = g_object_new (PASTRY_TYPE_ANNOTATION_OVERLAY, NULL);
+  pastry_annotation_overlay_set_child (
+      PASTRY_ANNOTATION_OVERLAY (overlay),
+      gtk_button_new_with_label ("Annotated"));
+
+  root = g_object_new (PASTRY_TYPE_GLASS_ROOT, NULL);
+  pastry_glass_root_set_child (PASTRY_GLASS_ROOT (root), overlay);
+
+  return root;
+}
+
+static GtkWidget *
+build_spinner (void)
+{
+  return g_object_new (PASTRY_TYPE_SPINNER, NULL);
+}
+
+static GtkWidget *
+build_grid_spinner (void)
+{
+  return g_object_new (PASTRY_TYPE_GRID_SPINNER, NULL);
+}